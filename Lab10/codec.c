@@ -0,0 +1,594 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Сжатие целого файла кодом Шеннона с настоящей упаковкой битов.
+// Длины кодов - как в 1.c (ceil(-log2 p)), но сами кодовые слова назначаются
+// канонически: по возрастанию (длина, символ). Длины те же, поэтому сжатие то же,
+// а в заголовке достаточно хранить только 256 длин.
+// Кодирование: таблица из 256 слов (код << 8 | длина) и 64-битный буфер битов,
+// который сбрасывается в выход целыми словами (старший бит - первым).
+// Декодирование: первичная таблица по префиксу из DECODE_PRIMARY_BITS бит и вторичные
+// таблицы для длинных кодов.
+// Сборка: gcc -O2 codec.c -o codec -lm
+// Запуск: ./codec -e <исходный файл> <сжатый файл>
+//         ./codec -d <сжатый файл> <восстановленный файл>
+//         ./codec -t <файл>...   (сжатие и восстановление в памяти со сверкой)
+
+#define MAX_SYMBOLS 256
+#define MAX_CODE_LENGTH 32
+#define SUB_HISTOGRAMS 4
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+#define DECODE_PRIMARY_BITS 11
+#define DECODE_SECONDARY_BITS 11
+
+#define CODEC_MAGIC "SHN1"
+// Заголовок: сигнатура, размер исходного файла (8 байт, младший первым), 256 длин
+#define CODEC_HEADER_SIZE (4 + 8 + MAX_SYMBOLS)
+
+typedef struct BitWriter {
+    uint64_t buffer;
+    int count;
+    unsigned char* out;
+    size_t out_used;
+    FILE* file;
+    size_t written;
+} BitWriter;
+
+// Отображенный входной файл
+typedef struct MappedFile {
+    const unsigned char* data;
+    size_t size;
+} MappedFile;
+
+int map_file(const char* filename, MappedFile* file) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        printf("Ошибка: не удалось открыть файл %s\n", filename);
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        printf("Ошибка: не удалось получить размер файла %s\n", filename);
+        close(fd);
+        return 0;
+    }
+    file->size = (size_t)st.st_size;
+    file->data = NULL;
+    if (file->size > 0) {
+        void* map = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            printf("Ошибка: mmap %s не удался\n", filename);
+            close(fd);
+            return 0;
+        }
+        madvise(map, file->size, MADV_SEQUENTIAL);
+        file->data = (const unsigned char*)map;
+    }
+    close(fd);
+    return 1;
+}
+
+void unmap_file(MappedFile* file) {
+    if (file->size > 0) munmap((void*)file->data, file->size);
+}
+
+// Частоты байтов с чередующимися подгистограммами, как в histogram.c
+void count_frequencies(const unsigned char* data, size_t size, uint64_t* counts) {
+    uint64_t sub[SUB_HISTOGRAMS][MAX_SYMBOLS];
+    memset(sub, 0, sizeof(sub));
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        sub[0][word & 0xFF]++;
+        sub[1][(word >> 8) & 0xFF]++;
+        sub[2][(word >> 16) & 0xFF]++;
+        sub[3][(word >> 24) & 0xFF]++;
+        sub[0][(word >> 32) & 0xFF]++;
+        sub[1][(word >> 40) & 0xFF]++;
+        sub[2][(word >> 48) & 0xFF]++;
+        sub[3][word >> 56]++;
+    }
+    for (; i < size; i++) sub[0][data[i]]++;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        counts[s] = sub[0][s] + sub[1][s] + sub[2][s] + sub[3][s];
+    }
+}
+
+// Длины Шеннона ceil(-log2 p). Для файлов больше 4 ГБ редкий символ может получить
+// длину больше MAX_CODE_LENGTH: она обрезается, а если после этого нарушено неравенство
+// Крафта, удлиняются самые длинные из кодов, которые еще можно удлинить
+void shannon_lengths(const uint64_t* counts, uint64_t total, int* lengths) {
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        lengths[s] = 0;
+        if (counts[s] == 0) continue;
+        int length = (int)ceil(-log2((double)counts[s] / total));
+        if (length < 1) length = 1;  // единственный символ все равно занимает бит
+        if (length > MAX_CODE_LENGTH) length = MAX_CODE_LENGTH;
+        lengths[s] = length;
+    }
+
+    // Сумма Крафта в единицах 2^-MAX_CODE_LENGTH
+    uint64_t kraft = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (lengths[s] > 0) kraft += 1ULL << (MAX_CODE_LENGTH - lengths[s]);
+    }
+    while (kraft > (1ULL << MAX_CODE_LENGTH)) {
+        int longest = -1;
+        for (int s = 0; s < MAX_SYMBOLS; s++) {
+            if (lengths[s] > 0 && lengths[s] < MAX_CODE_LENGTH &&
+                (longest < 0 || lengths[s] > lengths[longest])) {
+                longest = s;
+            }
+        }
+        kraft -= 1ULL << (MAX_CODE_LENGTH - lengths[longest] - 1);
+        lengths[longest]++;
+    }
+}
+
+// Канонические коды: внутри одной длины коды идут по возрастанию символа,
+// первый код длины L получается сдвигом следующего за последним кодом длины L-1
+void canonical_codes(const int* lengths, uint64_t* codes) {
+    int length_count[MAX_CODE_LENGTH + 1] = {0};
+    uint64_t next_code[MAX_CODE_LENGTH + 2] = {0};
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (lengths[s] > 0) length_count[lengths[s]]++;
+    }
+    uint64_t code = 0;
+    for (int length = 1; length <= MAX_CODE_LENGTH; length++) {
+        code = (code + length_count[length - 1]) << 1;
+        next_code[length] = code;
+    }
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        codes[s] = (lengths[s] > 0) ? next_code[lengths[s]]++ : 0;
+    }
+}
+
+// ---------------- Запись битов ----------------
+
+void writer_init(BitWriter* w, FILE* file) {
+    w->buffer = 0;
+    w->count = 0;
+    w->out = (unsigned char*)malloc(OUTPUT_BUFFER_SIZE);
+    w->out_used = 0;
+    w->file = file;
+    w->written = 0;
+}
+
+static inline void writer_flush_bytes(BitWriter* w) {
+    fwrite(w->out, 1, w->out_used, w->file);
+    w->written += w->out_used;
+    w->out_used = 0;
+}
+
+// Полное слово уходит в выход старшим байтом вперед
+static inline void writer_put_word(BitWriter* w, uint64_t word) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    memcpy(w->out + w->out_used, &word, sizeof(word));
+    w->out_used += sizeof(word);
+    if (w->out_used == OUTPUT_BUFFER_SIZE) writer_flush_bytes(w);
+}
+
+// Буфер никогда не остается полным: после добавления 64 бит он сразу сбрасывается
+static inline void writer_put(BitWriter* w, uint64_t code, int length) {
+    int room = 64 - w->count;
+    if (length < room) {
+        w->buffer = (w->buffer << length) | code;
+        w->count += length;
+    } else {
+        int rest = length - room;
+        uint64_t word = (room == 64) ? code : (w->buffer << room) | (code >> rest);
+        writer_put_word(w, word);
+        w->buffer = code & ((1ULL << rest) - 1);
+        w->count = rest;
+    }
+}
+
+// Остаток добивается нулями до целого байта
+void writer_finish(BitWriter* w) {
+    if (w->count > 0) {
+        uint64_t word = w->buffer << (64 - w->count);
+        int bytes = (w->count + 7) / 8;
+        for (int b = 0; b < bytes; b++) {
+            w->out[w->out_used++] = (unsigned char)(word >> (56 - 8 * b));
+        }
+        w->count = 0;
+    }
+    writer_flush_bytes(w);
+    free(w->out);
+}
+
+// ---------------- Кодирование ----------------
+
+typedef struct CodecStats {
+    size_t input_size;
+    size_t output_size;
+    double entropy;
+    double average_length;
+    double model_time;
+    double code_time;
+} CodecStats;
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void write_header(FILE* file, uint64_t original_size, const int* lengths) {
+    unsigned char header[CODEC_HEADER_SIZE];
+    memcpy(header, CODEC_MAGIC, 4);
+    for (int b = 0; b < 8; b++) header[4 + b] = (unsigned char)(original_size >> (8 * b));
+    for (int s = 0; s < MAX_SYMBOLS; s++) header[12 + s] = (unsigned char)lengths[s];
+    fwrite(header, 1, CODEC_HEADER_SIZE, file);
+}
+
+int encode_data(const unsigned char* data, size_t size, FILE* out, CodecStats* stats) {
+    double start = now_seconds();
+    uint64_t counts[MAX_SYMBOLS];
+    count_frequencies(data, size, counts);
+    int lengths[MAX_SYMBOLS];
+    uint64_t codes[MAX_SYMBOLS];
+    shannon_lengths(counts, size, lengths);
+    canonical_codes(lengths, codes);
+    stats->model_time = now_seconds() - start;
+
+    // Код и длина в одном слове: одна загрузка на символ
+    uint64_t table[MAX_SYMBOLS];
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        table[s] = (codes[s] << 8) | (uint64_t)lengths[s];
+    }
+
+    write_header(out, size, lengths);
+    BitWriter writer;
+    writer_init(&writer, out);
+    start = now_seconds();
+    for (size_t i = 0; i < size; i++) {
+        uint64_t entry = table[data[i]];
+        writer_put(&writer, entry >> 8, (int)(entry & 0xFF));
+    }
+    writer_finish(&writer);
+    stats->code_time = now_seconds() - start;
+
+    stats->entropy = 0;
+    stats->average_length = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (counts[s] == 0) continue;
+        double p = (double)counts[s] / size;
+        stats->entropy -= p * log2(p);
+        stats->average_length += p * lengths[s];
+    }
+    stats->input_size = size;
+    stats->output_size = CODEC_HEADER_SIZE + writer.written;
+    return !ferror(out);
+}
+
+// ---------------- Декодирование ----------------
+
+// Элемент таблицы декодирования. В первичной таблице (DECODE_PRIMARY_BITS бит префикса)
+// элемент либо сразу дает символ, либо ссылается на вторичную таблицу для кодов
+// длиннее префикса; коды длиннее DECODE_PRIMARY_BITS + DECODE_SECONDARY_BITS
+// разбираются по каноническим границам длин
+typedef struct DecodeEntry {
+    uint16_t symbol;
+    uint8_t length;
+    uint8_t kind;
+    uint32_t offset;
+} DecodeEntry;
+
+enum { ENTRY_INVALID, ENTRY_SYMBOL, ENTRY_SUBTABLE, ENTRY_SLOW };
+
+typedef struct Decoder {
+    DecodeEntry primary[1 << DECODE_PRIMARY_BITS];
+    DecodeEntry* secondary;
+    // Канонические коды длины L - это first_code[L] .. first_code[L] + length_count[L] - 1,
+    // символы идут в sorted_symbols начиная с first_index[L]
+    uint64_t first_code[MAX_CODE_LENGTH + 1];
+    int length_count[MAX_CODE_LENGTH + 1];
+    int first_index[MAX_CODE_LENGTH + 1];
+    unsigned char sorted_symbols[MAX_SYMBOLS];
+} Decoder;
+
+void decoder_init(Decoder* d, const int* lengths) {
+    uint64_t codes[MAX_SYMBOLS];
+    canonical_codes(lengths, codes);
+    const int K = DECODE_PRIMARY_BITS;
+
+    memset(d->length_count, 0, sizeof(d->length_count));
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (lengths[s] > 0) d->length_count[lengths[s]]++;
+    }
+    int index = 0;
+    for (int length = 1; length <= MAX_CODE_LENGTH; length++) {
+        d->first_index[length] = index;
+        d->first_code[length] = 0;
+        for (int s = 0; s < MAX_SYMBOLS; s++) {
+            if (lengths[s] != length) continue;
+            if (index == d->first_index[length]) d->first_code[length] = codes[s];
+            d->sorted_symbols[index++] = (unsigned char)s;
+        }
+    }
+
+    memset(d->primary, 0, sizeof(d->primary));
+    // Ширина вторичной таблицы префикса - по самому длинному коду под ним
+    int max_length[1 << DECODE_PRIMARY_BITS] = {0};
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        int length = lengths[s];
+        if (length == 0) continue;
+        if (length <= K) {
+            uint32_t first = (uint32_t)(codes[s] << (K - length));
+            for (uint32_t e = 0; e < (1u << (K - length)); e++) {
+                d->primary[first + e] = (DecodeEntry){(uint16_t)s, (uint8_t)length, ENTRY_SYMBOL, 0};
+            }
+        } else {
+            uint32_t prefix = (uint32_t)(codes[s] >> (length - K));
+            if (length > max_length[prefix]) max_length[prefix] = length;
+        }
+    }
+
+    size_t secondary_size = 0;
+    for (uint32_t p = 0; p < (1u << K); p++) {
+        if (max_length[p] == 0) continue;
+        int width = max_length[p] - K;
+        if (width > DECODE_SECONDARY_BITS) width = DECODE_SECONDARY_BITS;
+        d->primary[p] = (DecodeEntry){0, (uint8_t)width, ENTRY_SUBTABLE, (uint32_t)secondary_size};
+        secondary_size += (size_t)1 << width;
+    }
+    d->secondary = (DecodeEntry*)calloc(secondary_size > 0 ? secondary_size : 1, sizeof(DecodeEntry));
+
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        int length = lengths[s];
+        if (length <= K) continue;
+        DecodeEntry* table = &d->primary[codes[s] >> (length - K)];
+        int width = table->length;
+        DecodeEntry* sub = d->secondary + table->offset;
+        int rest = length - K;
+        uint64_t tail = codes[s] & ((1ULL << rest) - 1);
+        if (rest <= width) {
+            uint32_t first = (uint32_t)(tail << (width - rest));
+            for (uint32_t e = 0; e < (1u << (width - rest)); e++) {
+                sub[first + e] = (DecodeEntry){(uint16_t)s, (uint8_t)length, ENTRY_SYMBOL, 0};
+            }
+        } else {
+            sub[tail >> (rest - width)].kind = ENTRY_SLOW;
+        }
+    }
+}
+
+void decoder_free(Decoder* d) {
+    free(d->secondary);
+}
+
+// Медленный путь для самых длинных кодов: перебор длин по каноническим границам
+static inline int decode_slow(const Decoder* d, uint64_t buffer, int* length) {
+    for (int l = DECODE_PRIMARY_BITS + 1; l <= MAX_CODE_LENGTH; l++) {
+        uint64_t code = buffer >> (64 - l);
+        if (d->length_count[l] > 0 && code >= d->first_code[l] &&
+            code - d->first_code[l] < (uint64_t)d->length_count[l]) {
+            *length = l;
+            return d->sorted_symbols[d->first_index[l] + (code - d->first_code[l])];
+        }
+    }
+    return -1;
+}
+
+int decode_data(const unsigned char* data, size_t size, FILE* out, CodecStats* stats) {
+    if (size < CODEC_HEADER_SIZE || memcmp(data, CODEC_MAGIC, 4) != 0) {
+        printf("Ошибка: файл не является сжатым файлом Шеннона\n");
+        return 0;
+    }
+    uint64_t original_size = 0;
+    for (int b = 0; b < 8; b++) original_size |= (uint64_t)data[4 + b] << (8 * b);
+    int lengths[MAX_SYMBOLS];
+    uint64_t kraft = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        lengths[s] = data[12 + s];
+        if (lengths[s] > MAX_CODE_LENGTH) {
+            printf("Ошибка: длина кода %d больше %d\n", lengths[s], MAX_CODE_LENGTH);
+            return 0;
+        }
+        if (lengths[s] > 0) kraft += 1ULL << (MAX_CODE_LENGTH - lengths[s]);
+    }
+    if (kraft > (1ULL << MAX_CODE_LENGTH)) {
+        printf("Ошибка: длины кодов нарушают неравенство Крафта\n");
+        return 0;
+    }
+    // Каждый символ занимает хотя бы один бит
+    if (original_size > 8 * (uint64_t)(size - CODEC_HEADER_SIZE)) {
+        printf("Ошибка: размер %llu не помещается в %zu байт сжатых данных\n",
+               (unsigned long long)original_size, size - CODEC_HEADER_SIZE);
+        return 0;
+    }
+
+    double start = now_seconds();
+    Decoder* d = (Decoder*)malloc(sizeof(Decoder));
+    decoder_init(d, lengths);
+    stats->model_time = now_seconds() - start;
+
+    const unsigned char* p = data + CODEC_HEADER_SIZE;
+    const unsigned char* end = data + size;
+    unsigned char* buffer = (unsigned char*)malloc(OUTPUT_BUFFER_SIZE);
+    size_t used = 0;
+    // Непрочитанные биты выровнены по старшему краю; за концом входа идут нули,
+    // padding - сколько из count битов приходится на такие нули
+    uint64_t bits = 0;
+    int count = 0;
+    int padding = 0;
+    int ok = 1;
+
+    start = now_seconds();
+    for (uint64_t produced = 0; produced < original_size; produced++) {
+        if (count <= 32) {
+            if (end - p >= 4) {
+                uint32_t word;
+                memcpy(&word, p, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+                word = __builtin_bswap32(word);
+#endif
+                bits |= (uint64_t)word << (32 - count);
+                p += 4;
+                count += 32;
+            } else {
+                while (count <= 56) {
+                    if (p < end) bits |= (uint64_t)*p++ << (56 - count);
+                    else padding += 8;
+                    count += 8;
+                }
+            }
+        }
+
+        DecodeEntry e = d->primary[bits >> (64 - DECODE_PRIMARY_BITS)];
+        if (e.kind == ENTRY_SUBTABLE) {
+            e = d->secondary[e.offset + ((bits << DECODE_PRIMARY_BITS) >> (64 - e.length))];
+        }
+        int symbol, length;
+        if (e.kind == ENTRY_SYMBOL) {
+            symbol = e.symbol;
+            length = e.length;
+        } else if (e.kind == ENTRY_SLOW) {
+            symbol = decode_slow(d, bits, &length);
+        } else {
+            symbol = -1;
+        }
+        if (symbol < 0) {
+            printf("Ошибка: неверная кодовая последовательность на символе %llu\n",
+                   (unsigned long long)produced);
+            ok = 0;
+            break;
+        }
+
+        bits <<= length;
+        count -= length;
+        if (padding > count) {
+            printf("Ошибка: сжатые данные обрываются на символе %llu\n",
+                   (unsigned long long)produced);
+            ok = 0;
+            break;
+        }
+        buffer[used++] = (unsigned char)symbol;
+        if (used == OUTPUT_BUFFER_SIZE) {
+            fwrite(buffer, 1, used, out);
+            used = 0;
+        }
+    }
+    fwrite(buffer, 1, used, out);
+    stats->code_time = now_seconds() - start;
+    stats->input_size = size;
+    stats->output_size = (size_t)original_size;
+
+    free(buffer);
+    decoder_free(d);
+    free(d);
+    return ok && !ferror(out);
+}
+
+// ---------------- Режимы ----------------
+
+int process_file(const char* input, const char* output, int decode) {
+    MappedFile in;
+    if (!map_file(input, &in)) return 0;
+    FILE* out = fopen(output, "wb");
+    if (!out) {
+        printf("Ошибка: не удалось создать файл %s\n", output);
+        unmap_file(&in);
+        return 0;
+    }
+
+    CodecStats stats;
+    int ok = decode ? decode_data(in.data, in.size, out, &stats) : encode_data(in.data, in.size, out, &stats);
+    ok = (fclose(out) == 0) && ok;
+    unmap_file(&in);
+    if (!ok) {
+        printf("Ошибка обработки %s\n", input);
+        return 0;
+    }
+
+    if (decode) {
+        printf("Сжатый файл: %zu байт, восстановлено: %zu байт\n", stats.input_size, stats.output_size);
+        printf("Таблицы: %.4f с, декодирование: %.4f с (%.1f МБ/с)\n", stats.model_time, stats.code_time,
+               stats.code_time > 0 ? stats.output_size / 1048576.0 / stats.code_time : 0.0);
+    } else {
+        printf("Исходный файл: %zu байт, сжатый: %zu байт (%.2f%%)\n", stats.input_size, stats.output_size,
+               stats.input_size ? 100.0 * stats.output_size / stats.input_size : 0.0);
+        printf("Энтропия: %.4f бит/символ, средняя длина кода: %.4f бит/символ\n",
+               stats.entropy, stats.average_length);
+        printf("Частоты и коды: %.4f с, кодирование: %.4f с (%.1f МБ/с)\n", stats.model_time, stats.code_time,
+               stats.code_time > 0 ? stats.input_size / 1048576.0 / stats.code_time : 0.0);
+    }
+    return 1;
+}
+
+// Сжатие и восстановление в памяти для каждого файла с побайтовой сверкой
+int round_trip(int count, char* files[]) {
+    int all_ok = 1;
+    printf("+--------------------------------+------------+------------+------------+------------+------------+\n");
+    printf("| %-30s | %-10s | %-10s | %-10s | %-10s | %-10s |\n",
+           "Файл", "Байт", "Сжато, %", "Код., МБ/с", "Дек., МБ/с", "Проверка");
+    printf("+--------------------------------+------------+------------+------------+------------+------------+\n");
+    for (int f = 0; f < count; f++) {
+        MappedFile in;
+        if (!map_file(files[f], &in)) {
+            all_ok = 0;
+            continue;
+        }
+
+        char* packed = NULL;
+        size_t packed_size = 0;
+        FILE* packed_stream = open_memstream(&packed, &packed_size);
+        CodecStats encode_stats;
+        int ok = encode_data(in.data, in.size, packed_stream, &encode_stats);
+        fclose(packed_stream);
+
+        char* restored = NULL;
+        size_t restored_size = 0;
+        FILE* restored_stream = open_memstream(&restored, &restored_size);
+        CodecStats decode_stats;
+        ok = ok && decode_data((const unsigned char*)packed, packed_size, restored_stream, &decode_stats);
+        fclose(restored_stream);
+
+        ok = ok && restored_size == in.size && (in.size == 0 || memcmp(restored, in.data, in.size) == 0);
+        all_ok = all_ok && ok;
+        printf("| %-30s | %10zu | %10.2f | %10.1f | %10.1f | %-10s |\n", files[f], in.size,
+               in.size ? 100.0 * packed_size / in.size : 0.0,
+               encode_stats.code_time > 0 ? in.size / 1048576.0 / encode_stats.code_time : 0.0,
+               decode_stats.code_time > 0 ? in.size / 1048576.0 / decode_stats.code_time : 0.0,
+               ok ? "совпадает" : "ОШИБКА");
+
+        free(packed);
+        free(restored);
+        unmap_file(&in);
+    }
+    printf("+--------------------------------+------------+------------+------------+------------+------------+\n");
+    return all_ok;
+}
+
+void print_usage(const char* program) {
+    printf("Использование:\n");
+    printf("  %s -e <исходный файл> <сжатый файл>\n", program);
+    printf("  %s -d <сжатый файл> <восстановленный файл>\n", program);
+    printf("  %s -t <файл>...\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 4 && strcmp(argv[1], "-e") == 0) {
+        return process_file(argv[2], argv[3], 0) ? 0 : 1;
+    }
+    if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+        return process_file(argv[2], argv[3], 1) ? 0 : 1;
+    }
+    if (argc >= 3 && strcmp(argv[1], "-t") == 0) {
+        return round_trip(argc - 2, argv + 2) ? 0 : 1;
+    }
+    print_usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Подсчет частот байтов большого файла: файл отображается через mmap и делится
+// между потоками. Каждый поток ведет несколько чередующихся подгистограмм с 64-битными
+// счетчиками: подряд идущие одинаковые байты попадают в разные таблицы, и очередной
+// инкремент не ждет записи предыдущего в ту же ячейку. В конце таблицы суммируются.
+// Для сравнения - побайтовое чтение через fgetc, как в count_symbols.
+// Сборка: gcc -O2 -pthread histogram.c -o histogram
+// Запуск: ./histogram <файл> [потоков]
+
+#define MAX_SYMBOLS 256
+#define SUB_HISTOGRAMS 4
+
+typedef struct HistogramTask {
+    const unsigned char* data;
+    size_t size;
+    int sub_histograms;
+    uint64_t counts[MAX_SYMBOLS];
+} HistogramTask;
+
+// Слово из 8 байт раскладывается по подгистограммам: байт k идет в таблицу k % 4
+void count_interleaved(const unsigned char* data, size_t size, uint64_t* counts) {
+    uint64_t sub[SUB_HISTOGRAMS][MAX_SYMBOLS];
+    memset(sub, 0, sizeof(sub));
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        sub[0][word & 0xFF]++;
+        sub[1][(word >> 8) & 0xFF]++;
+        sub[2][(word >> 16) & 0xFF]++;
+        sub[3][(word >> 24) & 0xFF]++;
+        sub[0][(word >> 32) & 0xFF]++;
+        sub[1][(word >> 40) & 0xFF]++;
+        sub[2][(word >> 48) & 0xFF]++;
+        sub[3][word >> 56]++;
+    }
+    for (; i < size; i++) {
+        sub[0][data[i]]++;
+    }
+
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        counts[s] = sub[0][s] + sub[1][s] + sub[2][s] + sub[3][s];
+    }
+}
+
+// Одна таблица - для сравнения эффекта подгистограмм
+void count_single(const unsigned char* data, size_t size, uint64_t* counts) {
+    memset(counts, 0, MAX_SYMBOLS * sizeof(uint64_t));
+    for (size_t i = 0; i < size; i++) {
+        counts[data[i]]++;
+    }
+}
+
+void* histogram_worker(void* arg) {
+    HistogramTask* task = (HistogramTask*)arg;
+    if (task->sub_histograms > 1) count_interleaved(task->data, task->size, task->counts);
+    else count_single(task->data, task->size, task->counts);
+    return NULL;
+}
+
+// Гистограмма файла: threads частей примерно равного размера, результаты складываются
+// в counts. Возвращает 0 при ошибке открытия или отображения
+int histogram_file(const char* filename, int threads, int sub_histograms, uint64_t* counts, uint64_t* total) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        printf("Ошибка: не удалось открыть файл %s\n", filename);
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        printf("Ошибка: не удалось получить размер файла %s\n", filename);
+        close(fd);
+        return 0;
+    }
+    size_t size = (size_t)st.st_size;
+    memset(counts, 0, MAX_SYMBOLS * sizeof(uint64_t));
+    *total = size;
+    if (size == 0) {
+        close(fd);
+        return 1;
+    }
+
+    unsigned char* data = (unsigned char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        printf("Ошибка: mmap %s не удался\n", filename);
+        return 0;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    if ((size_t)threads > size) threads = (int)size;
+    HistogramTask* tasks = (HistogramTask*)malloc(threads * sizeof(HistogramTask));
+    pthread_t* workers = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    size_t part = size / threads;
+    for (int t = 0; t < threads; t++) {
+        tasks[t].data = data + part * t;
+        tasks[t].size = (t == threads - 1) ? size - part * t : part;
+        tasks[t].sub_histograms = sub_histograms;
+        if (t > 0) pthread_create(&workers[t], NULL, histogram_worker, &tasks[t]);
+    }
+    histogram_worker(&tasks[0]);
+    for (int t = 1; t < threads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    for (int t = 0; t < threads; t++) {
+        for (int s = 0; s < MAX_SYMBOLS; s++) {
+            counts[s] += tasks[t].counts[s];
+        }
+    }
+
+    free(tasks);
+    free(workers);
+    munmap(data, size);
+    return 1;
+}
+
+// Исходный способ: fgetc на каждый байт
+int histogram_fgetc(const char* filename, uint64_t* counts, uint64_t* total) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        printf("Ошибка: не удалось открыть файл %s\n", filename);
+        return 0;
+    }
+    memset(counts, 0, MAX_SYMBOLS * sizeof(uint64_t));
+    *total = 0;
+    int ch;
+    while ((ch = fgetc(file)) != EOF) {
+        counts[ch]++;
+        (*total)++;
+    }
+    fclose(file);
+    return 1;
+}
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void print_row(const char* method, double seconds, uint64_t total, int same) {
+    printf("| %-30s | %10.4f | %10.1f | %-10s |\n", method, seconds,
+           seconds > 0 ? total / 1048576.0 / seconds : 0.0, same ? "совпадает" : "ОШИБКА");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printf("Использование: %s <файл> [потоков]\n", argv[0]);
+        return 1;
+    }
+    const char* filename = argv[1];
+    int threads = (argc > 2) ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) threads = 1;
+
+    uint64_t reference[MAX_SYMBOLS], counts[MAX_SYMBOLS];
+    uint64_t total, reference_total;
+
+    double start = now_seconds();
+    if (!histogram_fgetc(filename, reference, &reference_total)) return 1;
+    double fgetc_time = now_seconds() - start;
+
+    printf("Файл: %s, размер: %.1f МБ, потоков: %d\n\n", filename, reference_total / 1048576.0, threads);
+    printf("+--------------------------------+------------+------------+------------+\n");
+    printf("| %-30s | %-10s | %-10s | %-10s |\n", "Способ", "Время, с", "МБ/с", "Частоты");
+    printf("+--------------------------------+------------+------------+------------+\n");
+    print_row("fgetc, int[256]", fgetc_time, reference_total, 1);
+
+    struct {
+        const char* name;
+        int threads;
+        int sub_histograms;
+    } variants[] = {
+        {"mmap, 1 поток, 1 таблица", 1, 1},
+        {"mmap, 1 поток, 4 таблицы", 1, SUB_HISTOGRAMS},
+        {"mmap, все потоки, 4 таблицы", threads, SUB_HISTOGRAMS},
+    };
+    int ok = 1;
+    for (int v = 0; v < 3; v++) {
+        start = now_seconds();
+        if (!histogram_file(filename, variants[v].threads, variants[v].sub_histograms, counts, &total)) return 1;
+        double elapsed = now_seconds() - start;
+        int same = total == reference_total && memcmp(counts, reference, sizeof(counts)) == 0;
+        ok = ok && same;
+        print_row(variants[v].name, elapsed, total, same);
+    }
+    printf("+--------------------------------+------------+------------+------------+\n");
+
+    int distinct = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (reference[s] > 0) distinct++;
+    }
+    printf("Различных байтов: %d\n", distinct);
+    return ok ? 0 : 1;
+}
@@ -1,20 +1,34 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
-#define MAX_SYMBOLS 256
-#define MAX_CODE_LENGTH 50
+#include "canonical.h"
 
+// Сборка: gcc -O2 -pthread 1.c -o task1 -lm
+
+#define MAX_CODE_LENGTH 64
+
+// Код хранится битами в code: младшие code_length бит, первый бит кода - старший.
+// Строка из '0' и '1' собирается только при печати
 typedef struct {
-    unsigned char symbol;
+    uint64_t code;
     double probability;
-    char code[MAX_CODE_LENGTH];
+    int frequency;
     int code_length;
+    unsigned char symbol;
 } SymbolInfo;
 
 typedef struct {
     SymbolInfo symbols[MAX_SYMBOLS];
+    uint64_t prefix[MAX_SYMBOLS + 1];
     int count;
     double kraft_sum;
     double entropy;
@@ -22,140 +36,46 @@ typedef struct {
     double redundancy;
 } FanoCode;
 
-// КЛАССИЧЕСКИЙ АЛГОРИТМ ФАНО - оригинальная медиана
-int find_median_classic(SymbolInfo* symbols, int left, int right) {
-    double left_sum = 0.0;
-    double right_sum = 0.0;
-    
-    for (int i = left; i < right; i++) {
-        left_sum += symbols[i].probability;
-    }
-    
-    right_sum = symbols[right].probability;
-    int median = right;
-    
-    while (left_sum >= right_sum && median > left) {
-        median--;
-        left_sum -= symbols[median].probability;
-        right_sum += symbols[median].probability;
-    }
-    
-    return median;
-}
-
-// АЛГОРИТМ A2 - медиана для почти оптимального дерева поиска
-int find_median_a2(SymbolInfo* symbols, int left, int right) {
-    if (left == right) return left;
-    
-    double total_weight = 0.0;
-    for (int i = left; i <= right; i++) {
-        total_weight += symbols[i].probability;
-    }
-    
-    double sum = 0.0;
-    int root_index = left;
-    
-    for (int i = left; i <= right; i++) {
-        double prev_sum = sum;
-        sum += symbols[i].probability;
-        
-        if (prev_sum < total_weight / 2.0 && sum > total_weight / 2.0) {
-            root_index = i;
-            break;
-        }
-    }
-    
-    return root_index;
-}
-
-// ЭНТРОПИЙНЫЙ МЕТОД - минимизация потери информации
-int find_median_entropy(SymbolInfo* symbols, int left, int right) {
-    if (left == right) return left;
-    
-    double total = 0.0;
-    for (int i = left; i <= right; i++) {
-        total += symbols[i].probability;
-    }
-    
-    double min_entropy_loss = 1e9;
-    int best_median = left;
-    
-    for (int i = left; i < right; i++) {
-        double left_sum = 0.0;
-        for (int j = left; j <= i; j++) {
-            left_sum += symbols[j].probability;
-        }
-        double right_sum = total - left_sum;
-        
-        // Энтропийный критерий - минимизируем потерю информации
-        double left_entropy = (left_sum > 0) ? -left_sum * log2(left_sum) : 0;
-        double right_entropy = (right_sum > 0) ? -right_sum * log2(right_sum) : 0;
-        double total_entropy = -total * log2(total);
-        
-        double entropy_loss = total_entropy - (left_entropy + right_entropy);
-        
-        if (entropy_loss < min_entropy_loss) {
-            min_entropy_loss = entropy_loss;
-            best_median = i;
-        }
-    }
-    
-    return best_median;
-}
-
 // Рекурсивная функция построения кода Фано (общая)
-void build_fano_code(SymbolInfo* symbols, int left, int right, int depth, int method) {
+void build_fano_code(FanoCode* fano, int left, int right, int depth, int method) {
+    SymbolInfo* symbols = fano->symbols;
     if (left < right) {
-        int median;
-        
-        switch (method) {
-            case 0: // Классический метод
-                median = find_median_classic(symbols, left, right);
-                break;
-            case 1: // Метод A2
-                median = find_median_a2(symbols, left, right);
-                break;
-            case 2: // Энтропийный метод
-                median = find_median_entropy(symbols, left, right);
-                break;
-            default:
-                median = find_median_classic(symbols, left, right);
-        }
+        // Медианы - общие с block.c и order1.c, см. canonical.h
+        int median = fano_median(fano->prefix, left, right, method);
         
+        // У всех символов отрезка уже ровно depth бит, очередной дописывается справа
         for (int i = left; i <= right; i++) {
-            if (i <= median) {
-                symbols[i].code[depth] = '0';
-            } else {
-                symbols[i].code[depth] = '1';
-            }
+            symbols[i].code = (symbols[i].code << 1) | (uint64_t)(i > median);
             symbols[i].code_length = depth + 1;
         }
         
-        build_fano_code(symbols, left, median, depth + 1, method);
-        build_fano_code(symbols, median + 1, right, depth + 1, method);
+        build_fano_code(fano, left, median, depth + 1, method);
+        build_fano_code(fano, median + 1, right, depth + 1, method);
     } else if (left == right) {
         symbols[left].code_length = depth;
     }
 }
 
-// Функция для чтения файла и подсчета частот
-int read_file_and_count(const char* filename, int* frequencies, long* total_chars) {
+// Функция для чтения файла и подсчета частот: файл читается в память целиком,
+// чтобы его можно было затем закодировать
+int read_file_and_count(const char* filename, int* frequencies, long* total_chars, unsigned char** data) {
     FILE* file = fopen(filename, "rb");
     if (!file) {
         printf("Ошибка: не удалось открыть файл %s\n", filename);
         return 0;
     }
     
-    memset(frequencies, 0, MAX_SYMBOLS * sizeof(int));
-    *total_chars = 0;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    *data = (unsigned char*)malloc(size > 0 ? size : 1);
+    *total_chars = (long)fread(*data, 1, size > 0 ? size : 0, file);
+    fclose(file);
     
-    int ch;
-    while ((ch = fgetc(file)) != EOF) {
-        frequencies[ch]++;
-        (*total_chars)++;
+    memset(frequencies, 0, MAX_SYMBOLS * sizeof(int));
+    for (long i = 0; i < *total_chars; i++) {
+        frequencies[(*data)[i]]++;
     }
-    
-    fclose(file);
     return 1;
 }
 
@@ -164,23 +84,32 @@ void init_symbols(SymbolInfo* symbols, int* count, int* frequencies, long total_
     for (int i = 0; i < MAX_SYMBOLS; i++) {
         if (frequencies[i] > 0) {
             symbols[*count].symbol = (unsigned char)i;
+            symbols[*count].frequency = frequencies[i];
             symbols[*count].probability = (double)frequencies[i] / total_chars;
             symbols[*count].code_length = 0;
-            memset(symbols[*count].code, 0, MAX_CODE_LENGTH);
+            symbols[*count].code = 0;
             (*count)++;
         }
     }
 }
 
+// По убыванию частоты, при равных частотах - по возрастанию символа
+int compare_by_probability(const void* a, const void* b) {
+    const SymbolInfo* sa = (const SymbolInfo*)a;
+    const SymbolInfo* sb = (const SymbolInfo*)b;
+    if (sa->frequency != sb->frequency) return (sa->frequency > sb->frequency) ? -1 : 1;
+    return (int)sa->symbol - (int)sb->symbol;
+}
+
 void sort_symbols_by_probability(SymbolInfo* symbols, int count) {
-    for (int i = 0; i < count - 1; i++) {
-        for (int j = 0; j < count - i - 1; j++) {
-            if (symbols[j].probability < symbols[j + 1].probability) {
-                SymbolInfo temp = symbols[j];
-                symbols[j] = symbols[j + 1];
-                symbols[j + 1] = temp;
-            }
-        }
+    qsort(symbols, count, sizeof(SymbolInfo), compare_by_probability);
+}
+
+// Вызывается один раз после сортировки, до построения кода
+void compute_prefix_sums(FanoCode* fano) {
+    fano->prefix[0] = 0;
+    for (int i = 0; i < fano->count; i++) {
+        fano->prefix[i + 1] = fano->prefix[i] + fano->symbols[i].frequency;
     }
 }
 
@@ -218,6 +147,15 @@ double calculate_total_probability(SymbolInfo* symbols, int count) {
     return total;
 }
 
+// Строка из '0' и '1' для печати, buffer - не меньше MAX_CODE_LENGTH + 1 байт
+const char* code_to_string(const SymbolInfo* symbol, char* buffer) {
+    for (int b = 0; b < symbol->code_length; b++) {
+        buffer[b] = ((symbol->code >> (symbol->code_length - 1 - b)) & 1) ? '1' : '0';
+    }
+    buffer[symbol->code_length] = '\0';
+    return buffer;
+}
+
 const char* get_method_name(int method) {
     switch (method) {
         case 0: return "Классический код Фано";
@@ -232,6 +170,7 @@ void print_code_table(SymbolInfo* symbols, int count, const char* method_name) {
     printf("Символ\t\tВероятность\tКодовое слово\tДлина\n");
     printf("------------------------------------------------------------\n");
     
+    char code_string[MAX_CODE_LENGTH + 1];
     for (int i = 0; i < count && i < 20; i++) {
         if (symbols[i].symbol >= 0xC0 && symbols[i].symbol <= 0xDF) {
             printf("RU-0x%02X\t", symbols[i].symbol);
@@ -244,7 +183,7 @@ void print_code_table(SymbolInfo* symbols, int count, const char* method_name) {
         
         printf("%.6f\t%s\t\t%d\n", 
                symbols[i].probability, 
-               symbols[i].code, 
+               code_to_string(&symbols[i], code_string), 
                symbols[i].code_length);
     }
     if (count > 20) {
@@ -274,17 +213,487 @@ void print_analysis_results(FanoCode* fano, const char* method_name) {
     printf("Эффективность:\t\t%.2f%%\n", (fano->entropy / fano->avg_length) * 100);
 }
 
+// Построение кода выбранным методом по уже подсчитанным частотам
+void build_method_code(FanoCode* fano, int* frequencies, long total_chars, int method) {
+    init_symbols(fano->symbols, &fano->count, frequencies, total_chars);
+    sort_symbols_by_probability(fano->symbols, fano->count);
+    compute_prefix_sums(fano);
+    build_fano_code(fano, 0, fano->count - 1, 0, method);
+    fano->kraft_sum = calculate_kraft_sum(fano->symbols, fano->count);
+    fano->entropy = calculate_entropy(fano->symbols, fano->count);
+    fano->avg_length = calculate_average_length(fano->symbols, fano->count);
+    fano->redundancy = fano->avg_length - fano->entropy;
+}
+
+// ---------------- Кодирование и декодирование ----------------
+
+// Сжатый поток: "FAN1", исходный размер (8 байт, младший байт первым), 256 длин
+// кодов и биты кодов (старший бит - первым). Коды в потоке канонические: длины
+// берутся из кода Фано, а сами кодовые слова назначаются по возрастанию (длина, символ),
+// поэтому декодеру достаточно длин. Длины те же - и сжатие то же, что у кода Фано.
+#define STREAM_MAGIC "FAN1"
+#define STREAM_HEADER_SIZE (4 + 8 + MAX_SYMBOLS)
+#define BENCH_BYTES (1 << 24)
+
+// Длины кодов по символам (0 - символа нет в файле)
+void code_lengths_by_symbol(const FanoCode* fano, int* lengths) {
+    memset(lengths, 0, MAX_SYMBOLS * sizeof(int));
+    for (int i = 0; i < fano->count; i++) {
+        lengths[fano->symbols[i].symbol] = fano->symbols[i].code_length;
+    }
+    // Единственный символ все равно должен занимать бит
+    if (fano->count == 1) lengths[fano->symbols[0].symbol] = 1;
+}
+
+// Кодирует data в out, возвращает размер потока. out - не меньше
+// STREAM_HEADER_SIZE + size * максимальная длина / 8 + 8 байт
+size_t encode_stream(const unsigned char* data, size_t size, const int* lengths, unsigned char* out) {
+    memcpy(out, STREAM_MAGIC, 4);
+    for (int b = 0; b < 8; b++) out[4 + b] = (unsigned char)((uint64_t)size >> (8 * b));
+    for (int s = 0; s < MAX_SYMBOLS; s++) out[12 + s] = (unsigned char)lengths[s];
+
+    return STREAM_HEADER_SIZE + encode_symbols(data, size, lengths, out + STREAM_HEADER_SIZE);
+}
+
+// Читает заголовок потока: исходный размер и длины кодов
+int read_stream_header(const unsigned char* stream, size_t stream_size, uint64_t* size, int* lengths) {
+    if (stream_size < STREAM_HEADER_SIZE || memcmp(stream, STREAM_MAGIC, 4) != 0) {
+        printf("Ошибка: поток не является сжатым кодом Фано\n");
+        return 0;
+    }
+    *size = 0;
+    for (int b = 0; b < 8; b++) *size |= (uint64_t)stream[4 + b] << (8 * b);
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        lengths[s] = stream[12 + s];
+        if (lengths[s] > MAX_STREAM_CODE_LENGTH) {
+            printf("Ошибка: длина кода %d больше %d\n", lengths[s], MAX_STREAM_CODE_LENGTH);
+            return 0;
+        }
+    }
+    // Каждый символ занимает хотя бы один бит
+    if (*size > 8 * (uint64_t)(stream_size - STREAM_HEADER_SIZE)) {
+        printf("Ошибка: размер %llu не помещается в %zu байт сжатых данных\n",
+               (unsigned long long)*size, stream_size - STREAM_HEADER_SIZE);
+        return 0;
+    }
+    return 1;
+}
+
+// Восстанавливает size байт потока в out, возвращает 0 при ошибке в потоке
+int decode_stream(const unsigned char* stream, size_t stream_size, unsigned char* out, uint64_t size) {
+    int lengths[MAX_SYMBOLS];
+    uint64_t header_size;
+    if (!read_stream_header(stream, stream_size, &header_size, lengths)) return 0;
+    Decoder decoder;
+    if (!decoder_init(&decoder, lengths)) {
+        printf("Ошибка: длины кодов нарушают неравенство Крафта\n");
+        return 0;
+    }
+
+    BitReader r;
+    reader_init(&r, stream + STREAM_HEADER_SIZE, stream_size - STREAM_HEADER_SIZE);
+    for (uint64_t i = 0; i < size; i++) {
+        int symbol = decode_symbol(&decoder, &r);
+        if (symbol == DECODE_TRUNCATED) {
+            printf("Ошибка: сжатый поток обрывается раньше конца данных\n");
+            return 0;
+        }
+        if (symbol < 0) {
+            printf("Ошибка: неверная кодовая последовательность на символе %llu\n",
+                   (unsigned long long)i);
+            return 0;
+        }
+        out[i] = (unsigned char)symbol;
+    }
+    return 1;
+}
+
+size_t stream_capacity(size_t size, const int* lengths) {
+    int max_length = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (lengths[s] > max_length) max_length = lengths[s];
+    }
+    return STREAM_HEADER_SIZE + size / 8 * max_length + max_length + 8;
+}
+
+typedef struct StreamStats {
+    size_t compressed_size;
+    double encode_speed;
+    double decode_speed;
+    int same;
+} StreamStats;
+
+// Сжатие и восстановление в памяти со сверкой. Малые файлы прогоняются несколько
+// раз, чтобы скорость не тонула в погрешности таймера
+void benchmark_stream(const unsigned char* data, size_t size, const FanoCode* fano, StreamStats* stats) {
+    int lengths[MAX_SYMBOLS];
+    code_lengths_by_symbol(fano, lengths);
+    unsigned char* stream = (unsigned char*)malloc(stream_capacity(size, lengths));
+    unsigned char* restored = (unsigned char*)malloc(size > 0 ? size : 1);
+    int rounds = (size > 0 && size < BENCH_BYTES) ? (int)(BENCH_BYTES / size) : 1;
+    double megabytes = (double)size * rounds / 1048576.0;
+
+    double start = now_seconds();
+    for (int r = 0; r < rounds; r++) {
+        stats->compressed_size = encode_stream(data, size, lengths, stream);
+    }
+    double elapsed = now_seconds() - start;
+    stats->encode_speed = elapsed > 0 ? megabytes / elapsed : 0;
+
+    int ok = 1;
+    start = now_seconds();
+    for (int r = 0; r < rounds && ok; r++) {
+        ok = decode_stream(stream, stats->compressed_size, restored, size);
+    }
+    elapsed = now_seconds() - start;
+    stats->decode_speed = elapsed > 0 ? megabytes / elapsed : 0;
+    stats->same = ok && memcmp(restored, data, size) == 0;
+
+    free(stream);
+    free(restored);
+}
+
+int parse_method(const char* name) {
+    if (strcmp(name, "classic") == 0) return 0;
+    if (strcmp(name, "a2") == 0) return 1;
+    if (strcmp(name, "entropy") == 0) return 2;
+    return -1;
+}
+
+// Сжатие файла кодом Фано выбранного метода
+int compress_file(const char* input, const char* output, int method) {
+    int frequencies[MAX_SYMBOLS];
+    long total_chars;
+    unsigned char* data;
+    if (!read_file_and_count(input, frequencies, &total_chars, &data)) return 0;
+
+    FanoCode* fano = (FanoCode*)malloc(sizeof(FanoCode));
+    build_method_code(fano, frequencies, total_chars, method);
+    int lengths[MAX_SYMBOLS];
+    code_lengths_by_symbol(fano, lengths);
+    int ok = 1;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (lengths[s] > MAX_STREAM_CODE_LENGTH) {
+            printf("Ошибка: длина кода %d больше %d\n", lengths[s], MAX_STREAM_CODE_LENGTH);
+            ok = 0;
+            break;
+        }
+    }
+
+    FILE* file = ok ? fopen(output, "wb") : NULL;
+    if (ok && !file) {
+        printf("Ошибка: не удалось создать файл %s\n", output);
+        ok = 0;
+    }
+    if (ok) {
+        unsigned char* stream = (unsigned char*)malloc(stream_capacity(total_chars, lengths));
+        size_t stream_size = encode_stream(data, total_chars, lengths, stream);
+        ok = fwrite(stream, 1, stream_size, file) == stream_size;
+        fclose(file);
+        printf("%s: %ld -> %zu байт (%s)\n", input, total_chars, stream_size, get_method_name(method));
+        free(stream);
+    }
+    free(fano);
+    free(data);
+    return ok;
+}
+
+int decompress_file(const char* input, const char* output) {
+    int frequencies[MAX_SYMBOLS];
+    long stream_size;
+    unsigned char* stream;
+    if (!read_file_and_count(input, frequencies, &stream_size, &stream)) return 0;
+
+    int lengths[MAX_SYMBOLS];
+    uint64_t size;
+    int ok = read_stream_header(stream, stream_size, &size, lengths);
+    unsigned char* restored = ok ? (unsigned char*)malloc(size > 0 ? size : 1) : NULL;
+    if (ok && !restored) {
+        printf("Ошибка: не хватает памяти на %llu байт\n", (unsigned long long)size);
+        ok = 0;
+    }
+    ok = ok && decode_stream(stream, stream_size, restored, size);
+    if (ok) {
+        FILE* file = fopen(output, "wb");
+        if (!file) {
+            printf("Ошибка: не удалось создать файл %s\n", output);
+            ok = 0;
+        } else {
+            ok = fwrite(restored, 1, size, file) == size;
+            fclose(file);
+        }
+    }
+    free(restored);
+    free(stream);
+    return ok;
+}
+
+// ---------------- Пакетный режим ----------------
+
+// Сначала пул потоков строит гистограммы файлов (по задаче на файл), затем строит
+// коды (по задаче на пару файл-метод). Задачи раздаются через атомарный счетчик.
+// Размер сжатого потока считается по длинам кодов без кодирования
+
+typedef struct BatchFile {
+    char* path;
+    int frequencies[MAX_SYMBOLS];
+    long total_chars;
+    int ok;
+} BatchFile;
+
+typedef struct BatchResult {
+    int symbols;
+    int max_length;
+    double entropy;
+    double avg_length;
+    double kraft_sum;
+    double redundancy;
+    size_t compressed_size;
+} BatchResult;
+
+typedef struct BatchContext {
+    BatchFile* files;
+    BatchResult* results;  // results[file * 3 + method]
+    int file_count;
+    int phase;             // 0 - гистограммы, 1 - коды
+    int task_count;
+    atomic_int next_task;
+} BatchContext;
+
+typedef struct FileList {
+    char** paths;
+    int count;
+    int capacity;
+} FileList;
+
+void file_list_add(FileList* list, const char* path) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 64;
+        list->paths = (char**)realloc(list->paths, list->capacity * sizeof(char*));
+    }
+    list->paths[list->count++] = strdup(path);
+}
+
+// Обычные файлы добавляются как есть, каталоги обходятся рекурсивно
+int collect_files(const char* path, FileList* list) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        printf("Ошибка: не удалось открыть %s\n", path);
+        return 0;
+    }
+    if (S_ISREG(st.st_mode)) {
+        file_list_add(list, path);
+        return 1;
+    }
+    if (!S_ISDIR(st.st_mode)) return 1;
+
+    DIR* dir = opendir(path);
+    if (!dir) {
+        printf("Ошибка: не удалось открыть каталог %s\n", path);
+        return 0;
+    }
+    int ok = 1;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        size_t length = strlen(path) + strlen(entry->d_name) + 2;
+        char* child = (char*)malloc(length);
+        snprintf(child, length, "%s/%s", path, entry->d_name);
+        ok = collect_files(child, list) && ok;
+        free(child);
+    }
+    closedir(dir);
+    return ok;
+}
+
+void batch_task(BatchContext* ctx, int task) {
+    if (ctx->phase == 0) {
+        BatchFile* file = &ctx->files[task];
+        unsigned char* data;
+        file->ok = read_file_and_count(file->path, file->frequencies, &file->total_chars, &data);
+        if (file->ok) free(data);
+        return;
+    }
+    BatchFile* file = &ctx->files[task / 3];
+    if (!file->ok) return;
+    int method = task % 3;
+    FanoCode fano;
+    build_method_code(&fano, file->frequencies, file->total_chars, method);
+    int lengths[MAX_SYMBOLS];
+    code_lengths_by_symbol(&fano, lengths);
+
+    BatchResult* result = &ctx->results[task];
+    uint64_t bits = 0;
+    result->max_length = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        bits += (uint64_t)file->frequencies[s] * lengths[s];
+        if (lengths[s] > result->max_length) result->max_length = lengths[s];
+    }
+    result->symbols = fano.count;
+    result->entropy = fano.entropy;
+    result->avg_length = fano.avg_length;
+    result->kraft_sum = fano.kraft_sum;
+    result->redundancy = fano.redundancy;
+    result->compressed_size = STREAM_HEADER_SIZE + (size_t)((bits + 7) / 8);
+}
+
+void* batch_worker(void* arg) {
+    BatchContext* ctx = (BatchContext*)arg;
+    for (;;) {
+        int task = atomic_fetch_add_explicit(&ctx->next_task, 1, memory_order_relaxed);
+        if (task >= ctx->task_count) break;
+        batch_task(ctx, task);
+    }
+    return NULL;
+}
+
+void run_batch_phase(BatchContext* ctx, int phase, int threads) {
+    ctx->phase = phase;
+    ctx->task_count = (phase == 0) ? ctx->file_count : ctx->file_count * 3;
+    atomic_init(&ctx->next_task, 0);
+    if (threads > ctx->task_count) threads = ctx->task_count > 0 ? ctx->task_count : 1;
+    pthread_t* workers = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    for (int t = 1; t < threads; t++) pthread_create(&workers[t], NULL, batch_worker, ctx);
+    batch_worker(ctx);
+    for (int t = 1; t < threads; t++) pthread_join(workers[t], NULL);
+    free(workers);
+}
+
+// Поле CSV в кавычках, если в нем есть запятая, кавычка или перевод строки
+void write_csv_field(FILE* out, const char* text) {
+    if (strpbrk(text, ",\"\n") == NULL) {
+        fputs(text, out);
+        return;
+    }
+    fputc('"', out);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"') fputc('"', out);
+        fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+int run_batch(int threads, const char* report, char** paths, int path_count) {
+    FileList list = {NULL, 0, 0};
+    for (int i = 0; i < path_count; i++) {
+        if (!collect_files(paths[i], &list)) return 0;
+    }
+    if (list.count == 0) {
+        printf("Ошибка: не найдено ни одного файла\n");
+        return 0;
+    }
+
+    BatchContext ctx;
+    ctx.file_count = list.count;
+    ctx.files = (BatchFile*)calloc(list.count, sizeof(BatchFile));
+    ctx.results = (BatchResult*)calloc((size_t)list.count * 3, sizeof(BatchResult));
+    for (int f = 0; f < list.count; f++) ctx.files[f].path = list.paths[f];
+
+    double start = now_seconds();
+    run_batch_phase(&ctx, 0, threads);
+    double histogram_time = now_seconds() - start;
+    start = now_seconds();
+    run_batch_phase(&ctx, 1, threads);
+    double build_time = now_seconds() - start;
+
+    FILE* out = fopen(report, "w");
+    if (!out) {
+        printf("Ошибка: не удалось создать файл %s\n", report);
+        return 0;
+    }
+    const char* method_keys[] = {"classic", "a2", "entropy"};
+    fprintf(out, "file,size,symbols,method,entropy,avg_length,kraft_sum,redundancy,efficiency,max_length,compressed_size,ratio\n");
+    long long total_bytes = 0;
+    long long method_bytes[3] = {0, 0, 0};
+    int failed = 0;
+    for (int f = 0; f < list.count; f++) {
+        BatchFile* file = &ctx.files[f];
+        if (!file->ok) {
+            failed++;
+            continue;
+        }
+        total_bytes += file->total_chars;
+        for (int m = 0; m < 3; m++) {
+            BatchResult* r = &ctx.results[f * 3 + m];
+            method_bytes[m] += (long long)r->compressed_size;
+            write_csv_field(out, file->path);
+            fprintf(out, ",%ld,%d,%s,%.6f,%.6f,%.6f,%.6f,%.2f,%d,%zu,%.4f\n",
+                    file->total_chars, r->symbols, method_keys[m], r->entropy, r->avg_length,
+                    r->kraft_sum, r->redundancy,
+                    r->avg_length > 0 ? r->entropy / r->avg_length * 100 : 0.0,
+                    r->max_length, r->compressed_size,
+                    file->total_chars > 0 ? (double)r->compressed_size / file->total_chars : 0.0);
+        }
+    }
+    int ok = !ferror(out);
+    fclose(out);
+
+    printf("Файлов: %d (ошибок: %d), объем: %.1f МБ, потоков: %d\n",
+           list.count, failed, total_bytes / 1048576.0, threads);
+    printf("Гистограммы: %.4f с, построение кодов: %.4f с\n", histogram_time, build_time);
+    for (int m = 0; m < 3; m++) {
+        printf("%s: сжатый объем %lld байт (%.2f%%)\n", get_method_name(m), method_bytes[m],
+               total_bytes > 0 ? 100.0 * method_bytes[m] / total_bytes : 0.0);
+    }
+    printf("Отчет: %s\n", report);
+
+    for (int f = 0; f < list.count; f++) free(list.paths[f]);
+    free(list.paths);
+    free(ctx.files);
+    free(ctx.results);
+    return ok && failed == 0;
+}
+
+void print_usage(const char* program) {
+    printf("Использование: %s <имя_файла>\n", program);
+    printf("               %s -e <classic|a2|entropy> <исходный файл> <сжатый файл>\n", program);
+    printf("               %s -d <сжатый файл> <восстановленный файл>\n", program);
+    printf("               %s -b [-t потоков] -o отчет.csv <файл или каталог>...\n", program);
+}
+
 int main(int argc, char* argv[]) {
+    if (argc == 5 && strcmp(argv[1], "-e") == 0) {
+        int method = parse_method(argv[2]);
+        if (method < 0) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return compress_file(argv[3], argv[4], method) ? 0 : 1;
+    }
+    if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+        return decompress_file(argv[2], argv[3]) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+        int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        const char* report = NULL;
+        int first_path = argc;
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+                threads = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+                report = argv[++i];
+            } else {
+                first_path = i;
+                break;
+            }
+        }
+        if (report == NULL || first_path >= argc || threads < 1) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return run_batch(threads, report, argv + first_path, argc - first_path) ? 0 : 1;
+    }
     if (argc != 2) {
-        printf("Использование: %s <имя_файла>\n", argv[0]);
+        print_usage(argv[0]);
         return 1;
     }
     
     const char* filename = argv[1];
     int frequencies[MAX_SYMBOLS];
     long total_chars;
+    unsigned char* data;
     
-    if (!read_file_and_count(filename, frequencies, &total_chars)) {
+    if (!read_file_and_count(filename, frequencies, &total_chars, &data)) {
         return 1;
     }
     
@@ -294,16 +703,12 @@ int main(int argc, char* argv[]) {
         printf("Предупреждение: файл меньше 10 КБ\n");
     }
     
-    // Создаем три копии для трех методов
+    // Три кода для трех методов
     FanoCode fano_classic, fano_a2, fano_entropy;
     
-    init_symbols(fano_classic.symbols, &fano_classic.count, frequencies, total_chars);
-    init_symbols(fano_a2.symbols, &fano_a2.count, frequencies, total_chars);
-    init_symbols(fano_entropy.symbols, &fano_entropy.count, frequencies, total_chars);
-    
-    sort_symbols_by_probability(fano_classic.symbols, fano_classic.count);
-    sort_symbols_by_probability(fano_a2.symbols, fano_a2.count);
-    sort_symbols_by_probability(fano_entropy.symbols, fano_entropy.count);
+    build_method_code(&fano_classic, frequencies, total_chars, 0);
+    build_method_code(&fano_a2, frequencies, total_chars, 1);
+    build_method_code(&fano_entropy, frequencies, total_chars, 2);
     
     printf("Обнаружено %d уникальных символов\n", fano_classic.count);
     
@@ -311,29 +716,6 @@ int main(int argc, char* argv[]) {
     double total_prob_before = calculate_total_probability(fano_classic.symbols, fano_classic.count);
     printf("Сумма вероятностей до кодирования: %.6f\n", total_prob_before);
     
-    // Построение кодов тремя методами
-    build_fano_code(fano_classic.symbols, 0, fano_classic.count - 1, 0, 0);
-    build_fano_code(fano_a2.symbols, 0, fano_a2.count - 1, 0, 1);
-    build_fano_code(fano_entropy.symbols, 0, fano_entropy.count - 1, 0, 2);
-    
-    // Вычисление характеристик для классического метода
-    fano_classic.kraft_sum = calculate_kraft_sum(fano_classic.symbols, fano_classic.count);
-    fano_classic.entropy = calculate_entropy(fano_classic.symbols, fano_classic.count);
-    fano_classic.avg_length = calculate_average_length(fano_classic.symbols, fano_classic.count);
-    fano_classic.redundancy = fano_classic.avg_length - fano_classic.entropy;
-    
-    // Вычисление характеристик для метода A2
-    fano_a2.kraft_sum = calculate_kraft_sum(fano_a2.symbols, fano_a2.count);
-    fano_a2.entropy = calculate_entropy(fano_a2.symbols, fano_a2.count);
-    fano_a2.avg_length = calculate_average_length(fano_a2.symbols, fano_a2.count);
-    fano_a2.redundancy = fano_a2.avg_length - fano_a2.entropy;
-    
-    // Вычисление характеристик для энтропийного метода
-    fano_entropy.kraft_sum = calculate_kraft_sum(fano_entropy.symbols, fano_entropy.count);
-    fano_entropy.entropy = calculate_entropy(fano_entropy.symbols, fano_entropy.count);
-    fano_entropy.avg_length = calculate_average_length(fano_entropy.symbols, fano_entropy.count);
-    fano_entropy.redundancy = fano_entropy.avg_length - fano_entropy.entropy;
-    
     // Вывод результатов для всех методов
     print_code_table(fano_classic.symbols, fano_classic.count, get_method_name(0));
     print_analysis_results(&fano_classic, get_method_name(0));
@@ -396,5 +778,29 @@ int main(int argc, char* argv[]) {
         printf("• Энтропийный метод ХУЖЕ метода A2 на %.6f\n", diff_vs_a2);
     }
     
-    return 0;
+    // Настоящее сжатие файла каждым кодом
+    FanoCode* methods[] = {&fano_classic, &fano_a2, &fano_entropy};
+    int all_same = 1;
+    printf("\nСЖАТИЕ ФАЙЛА (канонические коды, заголовок %d байт)\n", STREAM_HEADER_SIZE);
+    printf("+----------------------------------+------------+----------+------------+------------+------------+\n");
+    const char* headers[] = {"Метод", "Байт", "Сжатие", "Кодир.МБ/с", "Декод.МБ/с", "Проверка"};
+    int widths[] = {32, 10, 8, 10, 10, 10};
+    for (int c = 0; c < 6; c++) print_cell(headers[c], widths[c]);
+    printf("|\n");
+    printf("+----------------------------------+------------+----------+------------+------------+------------+\n");
+    for (int m = 0; m < 3; m++) {
+        StreamStats stats;
+        benchmark_stream(data, total_chars, methods[m], &stats);
+        all_same = all_same && stats.same;
+        print_cell(get_method_name(m), widths[0]);
+        printf("| %10zu | %7.2f%% | %10.1f | %10.1f ", stats.compressed_size,
+               total_chars > 0 ? 100.0 * stats.compressed_size / total_chars : 0.0,
+               stats.encode_speed, stats.decode_speed);
+        print_cell(stats.same ? "совпадает" : "ОШИБКА", widths[5]);
+        printf("|\n");
+    }
+    printf("+----------------------------------+------------+----------+------------+------------+------------+\n");
+    
+    free(data);
+    return all_same ? 0 : 1;
 }
\ No newline at end of file
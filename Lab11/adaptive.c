@@ -0,0 +1,505 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+
+// Адаптивный код Хаффмана (алгоритм FGK) за один проход: кодер и декодер ведут
+// одинаковое дерево и обновляют его после каждого символа, поэтому частоты заранее
+// не нужны и сжатие работает на каналах и потоках. Дерево хранит все вершины в
+// порядке номеров: веса не убывают с ростом номера, братья имеют соседние номера.
+// При увеличении веса вершина меняется местами со старшей по номеру вершиной
+// того же веса (если это не ее родитель), после чего вес увеличивается у нее и
+// у всех предков. Первое появление символа кодируется кодом пустого листа NYT
+// и 9 битами самого символа; конец потока - отдельный символ EOF_SYMBOL.
+// Память - дерево из 515 вершин и буферы; выход сбрасывается после каждой
+// прочитанной порции входа, так что задержка не зависит от длины потока.
+// Сборка: gcc -O2 adaptive.c -o adaptive -lm
+// Запуск: ./adaptive -e < исходный > сжатый
+//         ./adaptive -d < сжатый > восстановленный
+//         ./adaptive -t <файл>...   (сжатие и восстановление в памяти со сверкой)
+
+#define ALPHABET 257
+#define EOF_SYMBOL 256
+#define SYMBOL_BITS 9
+// Листья - все символы и NYT
+#define MAX_NODES (2 * (ALPHABET + 1) - 1)
+#define IO_BUFFER_SIZE (1 << 16)
+// Когда вес корня (число закодированных символов) доходит до этой границы, веса
+// листьев делятся пополам: иначе на бесконечном потоке int переполнится
+#ifndef MAX_ROOT_WEIGHT
+#define MAX_ROOT_WEIGHT (1 << 30)
+#endif
+
+typedef struct AdaptiveNode {
+    int weight;
+    int parent;
+    int left;    // -1 у листа
+    int right;
+    int symbol;  // -1 у внутренней вершины и NYT
+    int number;
+} AdaptiveNode;
+
+typedef struct AdaptiveTree {
+    AdaptiveNode nodes[MAX_NODES];
+    int by_number[MAX_NODES];
+    int leaf[ALPHABET];
+    int root;
+    int nyt;
+    int count;
+} AdaptiveTree;
+
+void tree_init(AdaptiveTree* t) {
+    for (int s = 0; s < ALPHABET; s++) t->leaf[s] = -1;
+    t->nodes[0] = (AdaptiveNode){0, -1, -1, -1, -1, MAX_NODES - 1};
+    t->by_number[MAX_NODES - 1] = 0;
+    t->root = 0;
+    t->nyt = 0;
+    t->count = 1;
+}
+
+// Меняет местами поддеревья a и b вместе с их номерами
+void swap_nodes(AdaptiveTree* t, int a, int b) {
+    AdaptiveNode* na = &t->nodes[a];
+    AdaptiveNode* nb = &t->nodes[b];
+    int pa = na->parent, pb = nb->parent;
+    if (pa == pb) {
+        int left = t->nodes[pa].left;
+        t->nodes[pa].left = t->nodes[pa].right;
+        t->nodes[pa].right = left;
+    } else {
+        if (t->nodes[pa].left == a) t->nodes[pa].left = b;
+        else t->nodes[pa].right = b;
+        if (t->nodes[pb].left == b) t->nodes[pb].left = a;
+        else t->nodes[pb].right = a;
+        na->parent = pb;
+        nb->parent = pa;
+    }
+    int number = na->number;
+    na->number = nb->number;
+    nb->number = number;
+    t->by_number[na->number] = a;
+    t->by_number[nb->number] = b;
+}
+
+// Новый символ: NYT становится внутренней вершиной с детьми - новым NYT и листом символа
+int split_nyt(AdaptiveTree* t, int symbol) {
+    int old = t->nyt;
+    int number = t->nodes[old].number;
+    int nyt = t->count++;
+    int leaf = t->count++;
+    t->nodes[nyt] = (AdaptiveNode){0, old, -1, -1, -1, number - 2};
+    t->nodes[leaf] = (AdaptiveNode){0, old, -1, -1, symbol, number - 1};
+    t->by_number[number - 2] = nyt;
+    t->by_number[number - 1] = leaf;
+    t->nodes[old].left = nyt;
+    t->nodes[old].right = leaf;
+    t->nyt = nyt;
+    t->leaf[symbol] = leaf;
+    return leaf;
+}
+
+// Делит веса листьев пополам с округлением вверх и строит дерево заново по Хаффману.
+// Вершины снимаются с двух очередей (листья по весу и новые внутренние вершины)
+// в порядке неубывания веса, братья - подряд, поэтому номера в порядке снятия
+// снова дают свойство братьев. NYT с весом 0 снимается первым и получает младший
+// номер, так что split_nyt по-прежнему берет два номера под ним. При равных весах
+// внутренняя вершина снимается раньше листа: родитель NYT весит столько же, сколько
+// брат NYT, и должен идти сразу за ним, иначе tree_update примет родителя за
+// старшую вершину блока и нарушит порядок весов
+void tree_rescale(AdaptiveTree* t) {
+    int symbols[ALPHABET + 1], weights[ALPHABET + 1];
+    int leaves = 0;
+    // Листья в порядке номеров; сортировка вставками устойчива, и кодер с декодером
+    // получают одно и то же дерево
+    for (int k = MAX_NODES - t->count; k < MAX_NODES; k++) {
+        AdaptiveNode* node = &t->nodes[t->by_number[k]];
+        if (node->left >= 0) continue;
+        int weight = (node->weight + 1) / 2, j = leaves++;
+        while (j > 0 && weights[j - 1] > weight) {
+            symbols[j] = symbols[j - 1];
+            weights[j] = weights[j - 1];
+            j--;
+        }
+        symbols[j] = node->symbol;
+        weights[j] = weight;
+    }
+
+    t->count = 0;
+    for (int i = 0; i < leaves; i++) {
+        int leaf = t->count++;
+        t->nodes[leaf] = (AdaptiveNode){weights[i], -1, -1, -1, symbols[i], 0};
+        if (symbols[i] < 0) t->nyt = leaf;
+        else t->leaf[symbols[i]] = leaf;
+    }
+    int queue[ALPHABET + 1];
+    int next_leaf = 0, head = 0, tail = 0;
+    int number = MAX_NODES - (2 * leaves - 1);
+    for (;;) {
+        int taken[2];
+        for (int c = 0; c < 2; c++) {
+            int node;
+            if (next_leaf < leaves &&
+                (head == tail || t->nodes[next_leaf].weight < t->nodes[queue[head]].weight)) {
+                node = next_leaf++;
+            } else {
+                node = queue[head++];
+            }
+            t->nodes[node].number = number;
+            t->by_number[number++] = node;
+            taken[c] = node;
+            if (number == MAX_NODES) {
+                t->root = node;
+                return;
+            }
+        }
+        int parent = t->count++;
+        t->nodes[parent] = (AdaptiveNode){t->nodes[taken[0]].weight + t->nodes[taken[1]].weight,
+                                          -1, taken[0], taken[1], -1, 0};
+        t->nodes[taken[0]].parent = parent;
+        t->nodes[taken[1]].parent = parent;
+        queue[tail++] = parent;
+    }
+}
+
+void tree_update(AdaptiveTree* t, int symbol) {
+    int p = t->leaf[symbol];
+    if (p < 0) p = split_nyt(t, symbol);
+    while (p >= 0) {
+        // Вершины одного веса занимают подряд идущие номера
+        int weight = t->nodes[p].weight;
+        int k = t->nodes[p].number;
+        while (k + 1 < MAX_NODES && t->nodes[t->by_number[k + 1]].weight == weight) k++;
+        int leader = t->by_number[k];
+        if (leader != p && leader != t->nodes[p].parent) swap_nodes(t, p, leader);
+        t->nodes[p].weight++;
+        p = t->nodes[p].parent;
+    }
+    // Кодер и декодер вызывают tree_update после каждого символа, и масштабирование
+    // происходит у обоих на одном и том же символе
+    if (t->nodes[t->root].weight >= MAX_ROOT_WEIGHT) tree_rescale(t);
+}
+
+// ---------------- Запись и чтение битов ----------------
+
+typedef struct BitWriter {
+    uint64_t buffer;
+    int count;
+    unsigned char out[IO_BUFFER_SIZE];
+    size_t used;
+    FILE* file;
+    size_t written;
+} BitWriter;
+
+void writer_init(BitWriter* w, FILE* file) {
+    w->buffer = 0;
+    w->count = 0;
+    w->used = 0;
+    w->file = file;
+    w->written = 0;
+}
+
+void writer_flush(BitWriter* w) {
+    fwrite(w->out, 1, w->used, w->file);
+    fflush(w->file);
+    w->written += w->used;
+    w->used = 0;
+}
+
+// length не больше 32; полные байты сразу уходят в выходной буфер
+static inline void writer_put(BitWriter* w, uint32_t bits, int length) {
+    w->buffer = (w->buffer << length) | bits;
+    w->count += length;
+    while (w->count >= 8) {
+        w->count -= 8;
+        w->out[w->used++] = (unsigned char)(w->buffer >> w->count);
+        if (w->used == IO_BUFFER_SIZE) writer_flush(w);
+    }
+}
+
+// Остаток добивается нулями до целого байта
+void writer_finish(BitWriter* w) {
+    if (w->count > 0) writer_put(w, 0, 8 - w->count);
+    writer_flush(w);
+}
+
+// ---------------- Кодирование ----------------
+
+void encode_symbol(AdaptiveTree* t, BitWriter* w, int symbol) {
+    int node = t->leaf[symbol];
+    int is_new = node < 0;
+    if (is_new) node = t->nyt;
+
+    // Путь собирается от листа к корню, а выводится от корня
+    unsigned char path[MAX_NODES];
+    int depth = 0;
+    while (node != t->root) {
+        int parent = t->nodes[node].parent;
+        path[depth++] = t->nodes[parent].right == node;
+        node = parent;
+    }
+    while (depth > 0) writer_put(w, path[--depth], 1);
+    if (is_new) writer_put(w, (uint32_t)symbol, SYMBOL_BITS);
+    tree_update(t, symbol);
+}
+
+void encode_chunk(AdaptiveTree* t, BitWriter* w, const unsigned char* data, size_t size) {
+    for (size_t i = 0; i < size; i++) encode_symbol(t, w, data[i]);
+}
+
+// ---------------- Декодирование ----------------
+
+// Декодер разбирает вход побитно и помнит, где остановился, поэтому вход можно
+// подавать порциями произвольной длины
+typedef struct Decoder {
+    AdaptiveTree tree;
+    int node;        // текущая вершина пути от корня
+    int raw_bits;    // сколько бит символа после NYT уже прочитано (-1 - не читаем)
+    int raw_value;
+    int finished;    // встречен EOF_SYMBOL
+    int corrupt;     // символ после NYT вне алфавита или уже есть в дереве
+} Decoder;
+
+void decoder_init(Decoder* d) {
+    tree_init(&d->tree);
+    d->node = d->tree.root;
+    // Пока дерево пустое, корень - это NYT, и код NYT пустой
+    d->raw_bits = 0;
+    d->raw_value = 0;
+    d->finished = 0;
+    d->corrupt = 0;
+}
+
+// Возвращает 0, если после EOF_SYMBOL еще идут данные или поток испорчен (corrupt)
+int decode_chunk(Decoder* d, const unsigned char* data, size_t size, BitWriter* out) {
+    AdaptiveTree* t = &d->tree;
+    for (size_t i = 0; i < size; i++) {
+        if (d->finished) {
+            // После EOF допустимы только нули дополнения последнего байта
+            return 0;
+        }
+        for (int b = 7; b >= 0 && !d->finished; b--) {
+            int bit = (data[i] >> b) & 1;
+            int symbol = -1;
+            if (d->raw_bits >= 0) {
+                d->raw_value = (d->raw_value << 1) | bit;
+                if (++d->raw_bits == SYMBOL_BITS) {
+                    symbol = d->raw_value;
+                    // После NYT может прийти только символ, которого еще нет в дереве
+                    if (symbol > EOF_SYMBOL || t->leaf[symbol] >= 0) {
+                        d->corrupt = 1;
+                        return 0;
+                    }
+                }
+            } else {
+                d->node = bit ? t->nodes[d->node].right : t->nodes[d->node].left;
+                if (d->node == t->nyt) {
+                    d->raw_bits = 0;
+                    d->raw_value = 0;
+                } else if (t->nodes[d->node].left < 0) {
+                    symbol = t->nodes[d->node].symbol;
+                }
+            }
+            if (symbol < 0) continue;
+
+            if (symbol == EOF_SYMBOL) {
+                d->finished = 1;
+                break;
+            }
+            writer_put(out, (uint32_t)symbol, 8);
+            tree_update(t, symbol);
+            d->node = t->root;
+            d->raw_bits = -1;
+        }
+    }
+    return 1;
+}
+
+// ---------------- Режимы ----------------
+
+// Порция входа - столько, сколько уже доступно, а не полный буфер: read на канале
+// возвращается, как только пришли данные
+ssize_t read_chunk(int fd, unsigned char* buffer, size_t size) {
+    for (;;) {
+        ssize_t n = read(fd, buffer, size);
+        if (n >= 0 || errno != EINTR) return n;
+    }
+}
+
+int encode_stream(int in_fd, FILE* out) {
+    AdaptiveTree* tree = (AdaptiveTree*)malloc(sizeof(AdaptiveTree));
+    BitWriter* writer = (BitWriter*)malloc(sizeof(BitWriter));
+    unsigned char* buffer = (unsigned char*)malloc(IO_BUFFER_SIZE);
+    tree_init(tree);
+    writer_init(writer, out);
+    ssize_t n;
+    while ((n = read_chunk(in_fd, buffer, IO_BUFFER_SIZE)) > 0) {
+        encode_chunk(tree, writer, buffer, (size_t)n);
+        writer_flush(writer);
+    }
+    encode_symbol(tree, writer, EOF_SYMBOL);
+    writer_finish(writer);
+    int ok = n == 0 && !ferror(out);
+    if (n < 0) fprintf(stderr, "Ошибка чтения входа\n");
+    free(tree);
+    free(writer);
+    free(buffer);
+    return ok;
+}
+
+int decode_stream(int in_fd, FILE* out) {
+    Decoder* decoder = (Decoder*)malloc(sizeof(Decoder));
+    BitWriter* writer = (BitWriter*)malloc(sizeof(BitWriter));
+    unsigned char* buffer = (unsigned char*)malloc(IO_BUFFER_SIZE);
+    decoder_init(decoder);
+    writer_init(writer, out);
+    ssize_t n;
+    int ok = 1;
+    while (ok && (n = read_chunk(in_fd, buffer, IO_BUFFER_SIZE)) > 0) {
+        ok = decode_chunk(decoder, buffer, (size_t)n, writer);
+        writer_flush(writer);
+    }
+    if (decoder->corrupt) fprintf(stderr, "Ошибка: поток поврежден\n");
+    else if (!ok) fprintf(stderr, "Ошибка: данные после конца потока\n");
+    else if (n < 0) fprintf(stderr, "Ошибка чтения входа\n");
+    else if (!decoder->finished) fprintf(stderr, "Ошибка: поток обрывается до символа конца\n");
+    ok = ok && n == 0 && decoder->finished && !ferror(out);
+    free(decoder);
+    free(writer);
+    free(buffer);
+    return ok;
+}
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Энтропия нулевого порядка - нижняя граница для любого статического побайтового кода
+double entropy_of(const unsigned char* data, size_t size) {
+    long long counts[256] = {0};
+    for (size_t i = 0; i < size; i++) counts[data[i]]++;
+    double entropy = 0;
+    for (int s = 0; s < 256; s++) {
+        if (counts[s] == 0) continue;
+        double p = (double)counts[s] / size;
+        entropy -= p * log2(p);
+    }
+    return entropy;
+}
+
+int read_file(const char* filename, unsigned char** data, size_t* size) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        printf("Ошибка: не удалось открыть файл %s\n", filename);
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    *data = (unsigned char*)malloc(length > 0 ? length : 1);
+    *size = fread(*data, 1, length > 0 ? length : 0, file);
+    fclose(file);
+    return 1;
+}
+
+// Ячейка таблицы шириной width символов: printf считает ширину в байтах, а
+// кириллица в UTF-8 занимает два байта на букву
+void print_cell(const char* text, int width) {
+    int length = 0;
+    for (const char* c = text; *c; c++) {
+        if ((*c & 0xC0) != 0x80) length++;
+    }
+    printf("| %s%*s ", text, width > length ? width - length : 0, "");
+}
+
+int round_trip(int count, char* files[]) {
+    const char* headers[] = {"Файл", "Байт", "Сжато, %", "Бит/симв", "Энтропия", "Код.МБ/с", "Дек.МБ/с", "Проверка"};
+    int widths[] = {30, 10, 9, 9, 9, 9, 9, 10};
+    const char* line = "+--------------------------------+------------+-----------+-----------+-----------"
+                       "+-----------+-----------+------------+\n";
+    printf("%s", line);
+    for (int c = 0; c < 8; c++) print_cell(headers[c], widths[c]);
+    printf("|\n%s", line);
+
+    int all_ok = 1;
+    for (int f = 0; f < count; f++) {
+        unsigned char* data;
+        size_t size;
+        if (!read_file(files[f], &data, &size)) {
+            all_ok = 0;
+            continue;
+        }
+
+        char* packed = NULL;
+        size_t packed_size = 0;
+        FILE* packed_stream = open_memstream(&packed, &packed_size);
+        AdaptiveTree* tree = (AdaptiveTree*)malloc(sizeof(AdaptiveTree));
+        BitWriter* writer = (BitWriter*)malloc(sizeof(BitWriter));
+        tree_init(tree);
+        writer_init(writer, packed_stream);
+        double start = now_seconds();
+        encode_chunk(tree, writer, data, size);
+        encode_symbol(tree, writer, EOF_SYMBOL);
+        writer_finish(writer);
+        double encode_time = now_seconds() - start;
+        fclose(packed_stream);
+
+        char* restored = NULL;
+        size_t restored_size = 0;
+        FILE* restored_stream = open_memstream(&restored, &restored_size);
+        Decoder* decoder = (Decoder*)malloc(sizeof(Decoder));
+        decoder_init(decoder);
+        writer_init(writer, restored_stream);
+        start = now_seconds();
+        int ok = decode_chunk(decoder, (const unsigned char*)packed, packed_size, writer) && decoder->finished;
+        writer_flush(writer);
+        double decode_time = now_seconds() - start;
+        fclose(restored_stream);
+
+        ok = ok && restored_size == size && (size == 0 || memcmp(restored, data, size) == 0);
+        all_ok = all_ok && ok;
+        print_cell(files[f], widths[0]);
+        printf("| %10zu | %9.2f | %9.4f | %9.4f | %9.1f | %9.1f ", size,
+               size ? 100.0 * packed_size / size : 0.0,
+               size ? 8.0 * packed_size / size : 0.0, entropy_of(data, size),
+               encode_time > 0 ? size / 1048576.0 / encode_time : 0.0,
+               decode_time > 0 ? size / 1048576.0 / decode_time : 0.0);
+        print_cell(ok ? "совпадает" : "ОШИБКА", widths[7]);
+        printf("|\n");
+
+        free(tree);
+        free(writer);
+        free(decoder);
+        free(packed);
+        free(restored);
+        free(data);
+    }
+    printf("%s", line);
+    return all_ok;
+}
+
+void print_usage(const char* program) {
+    printf("Использование:\n");
+    printf("  %s -e < исходный > сжатый\n", program);
+    printf("  %s -d < сжатый > восстановленный\n", program);
+    printf("  %s -t <файл>...\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 2 && strcmp(argv[1], "-e") == 0) {
+        return encode_stream(STDIN_FILENO, stdout) ? 0 : 1;
+    }
+    if (argc == 2 && strcmp(argv[1], "-d") == 0) {
+        return decode_stream(STDIN_FILENO, stdout) ? 0 : 1;
+    }
+    if (argc >= 3 && strcmp(argv[1], "-t") == 0) {
+        return round_trip(argc - 2, argv + 2) ? 0 : 1;
+    }
+    print_usage(argv[0]);
+    return 1;
+}
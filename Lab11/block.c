@@ -0,0 +1,352 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "canonical.h"
+
+// Блочное сжатие: файл режется на блоки, для каждого блока строится своя гистограмма
+// и выбирается самый короткий вариант - код Шеннона (как в Lab10), код Фано (лучшая из
+// трех медиан 1.c) или блок без сжатия. Коды канонические, в заголовке блока - только
+// длины кодов присутствующих символов. Каждый блок декодируется независимо: заголовок
+// хранит размер блока до и после сжатия, так что блок можно найти, пропуская предыдущие.
+// Формат: "BLK1", размер блока (4 байта), затем блоки:
+//   тип (1 байт), исходный размер (4 байта), размер данных блока (4 байта), данные.
+// Данные сжатого блока: битовая карта присутствующих символов (32 байта), по байту
+// длины на каждый присутствующий символ и биты кодов (старший бит - первым).
+// Сборка: gcc -O2 block.c -o block -lm
+// Запуск: ./block -e [-s размер блока, КБ] <исходный файл> <сжатый файл>
+//         ./block -d <сжатый файл> <восстановленный файл>
+//         ./block -t [-s размер блока, КБ] <файл>...   (сравнение с одним кодом на файл)
+
+#define DEFAULT_BLOCK_KB 64
+#define MIN_BLOCK_KB 1
+#define MAX_BLOCK_KB (16 << 10)
+
+#define STREAM_MAGIC "BLK1"
+#define STREAM_HEADER_SIZE 8
+#define BLOCK_HEADER_SIZE 9
+#define BITMAP_SIZE (MAX_SYMBOLS / 8)
+
+enum BlockKind { BLOCK_RAW = 0, BLOCK_SHANNON = 1, BLOCK_FANO = 2 };
+
+// Выбранный способ кодирования блока и его стоимость в байтах вместе с заголовком
+typedef struct BlockPlan {
+    int kind;
+    int lengths[MAX_SYMBOLS];
+    size_t cost;
+} BlockPlan;
+
+typedef struct BlockStats {
+    size_t input_size;
+    size_t output_size;
+    int blocks[3];
+    double code_time;
+} BlockStats;
+
+// ---------------- Выбор способа для блока ----------------
+
+// Стоимость блока - заголовок, таблица длин и биты кодов; из кодов Фано берется
+// лучшая из трех медиан
+void plan_block(const unsigned char* data, size_t size, BlockPlan* plan) {
+    uint64_t counts[MAX_SYMBOLS] = {0};
+    for (size_t i = 0; i < size; i++) counts[data[i]]++;
+    int present = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (counts[s] > 0) present++;
+    }
+
+    plan->kind = BLOCK_RAW;
+    plan->cost = BLOCK_HEADER_SIZE + size;
+    memset(plan->lengths, 0, sizeof(plan->lengths));
+    if (size == 0) return;
+
+    size_t table = BITMAP_SIZE + present;
+    int lengths[MAX_SYMBOLS];
+    for (int variant = 0; variant < 4; variant++) {
+        if (variant == 0) shannon_lengths(counts, size, lengths);
+        else fano_lengths(counts, variant - 1, lengths);
+        if (max_length(lengths) > MAX_STREAM_CODE_LENGTH) continue;
+        size_t cost = BLOCK_HEADER_SIZE + table + (size_t)((code_bits(counts, lengths) + 7) / 8);
+        if (cost < plan->cost) {
+            plan->kind = (variant == 0) ? BLOCK_SHANNON : BLOCK_FANO;
+            plan->cost = cost;
+            memcpy(plan->lengths, lengths, sizeof(lengths));
+        }
+    }
+}
+
+// ---------------- Кодирование ----------------
+
+static inline void put_u32(unsigned char* out, uint32_t value) {
+    for (int b = 0; b < 4; b++) out[b] = (unsigned char)(value >> (8 * b));
+}
+
+static inline uint32_t get_u32(const unsigned char* in) {
+    uint32_t value = 0;
+    for (int b = 0; b < 4; b++) value |= (uint32_t)in[b] << (8 * b);
+    return value;
+}
+
+// Пишет блок в out (не меньше plan->cost байт), возвращает его размер
+size_t encode_block(const unsigned char* data, size_t size, const BlockPlan* plan, unsigned char* out) {
+    out[0] = (unsigned char)plan->kind;
+    put_u32(out + 1, (uint32_t)size);
+    size_t used = BLOCK_HEADER_SIZE;
+    if (plan->kind == BLOCK_RAW) {
+        memcpy(out + used, data, size);
+        used += size;
+        put_u32(out + 5, (uint32_t)(used - BLOCK_HEADER_SIZE));
+        return used;
+    }
+
+    unsigned char* bitmap = out + used;
+    memset(bitmap, 0, BITMAP_SIZE);
+    used += BITMAP_SIZE;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (plan->lengths[s] == 0) continue;
+        bitmap[s / 8] |= (unsigned char)(1 << (s % 8));
+        out[used++] = (unsigned char)plan->lengths[s];
+    }
+
+    used += encode_symbols(data, size, plan->lengths, out + used);
+    put_u32(out + 5, (uint32_t)(used - BLOCK_HEADER_SIZE));
+    return used;
+}
+
+int encode_data(const unsigned char* data, size_t size, size_t block_size, FILE* out, BlockStats* stats) {
+    unsigned char header[STREAM_HEADER_SIZE];
+    memcpy(header, STREAM_MAGIC, 4);
+    put_u32(header + 4, (uint32_t)block_size);
+    fwrite(header, 1, STREAM_HEADER_SIZE, out);
+
+    memset(stats, 0, sizeof(BlockStats));
+    stats->input_size = size;
+    stats->output_size = STREAM_HEADER_SIZE;
+    unsigned char* buffer = (unsigned char*)malloc(BLOCK_HEADER_SIZE + block_size);
+    BlockPlan plan;
+    double start = now_seconds();
+    for (size_t begin = 0; begin < size; begin += block_size) {
+        size_t length = (size - begin < block_size) ? size - begin : block_size;
+        plan_block(data + begin, length, &plan);
+        size_t written = encode_block(data + begin, length, &plan, buffer);
+        fwrite(buffer, 1, written, out);
+        stats->output_size += written;
+        stats->blocks[plan.kind]++;
+    }
+    stats->code_time = now_seconds() - start;
+    free(buffer);
+    return !ferror(out);
+}
+
+// ---------------- Декодирование ----------------
+
+// Декодирует один блок по его заголовку и данным; out - не меньше исходного размера блока
+int decode_block(int kind, const unsigned char* payload, size_t payload_size, unsigned char* out, size_t size) {
+    if (kind == BLOCK_RAW) {
+        if (payload_size != size) return 0;
+        memcpy(out, payload, size);
+        return 1;
+    }
+    if (kind != BLOCK_SHANNON && kind != BLOCK_FANO) return 0;
+    if (payload_size < BITMAP_SIZE) return 0;
+
+    int lengths[MAX_SYMBOLS];
+    size_t pos = BITMAP_SIZE;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        lengths[s] = 0;
+        if (!(payload[s / 8] & (1 << (s % 8)))) continue;
+        if (pos >= payload_size) return 0;
+        lengths[s] = payload[pos++];
+        if (lengths[s] == 0 || lengths[s] > MAX_STREAM_CODE_LENGTH) return 0;
+    }
+    Decoder* d = (Decoder*)malloc(sizeof(Decoder));
+    if (!decoder_init(d, lengths)) {
+        free(d);
+        return 0;
+    }
+
+    BitReader r;
+    reader_init(&r, payload + pos, payload_size - pos);
+    int ok = 1;
+    for (size_t i = 0; i < size; i++) {
+        int symbol = decode_symbol(d, &r);
+        if (symbol < 0) {
+            ok = 0;
+            break;
+        }
+        out[i] = (unsigned char)symbol;
+    }
+    free(d);
+    return ok;
+}
+
+int decode_data(const unsigned char* data, size_t size, FILE* out, BlockStats* stats) {
+    if (size < STREAM_HEADER_SIZE || memcmp(data, STREAM_MAGIC, 4) != 0) {
+        printf("Ошибка: файл не является блочным сжатым файлом\n");
+        return 0;
+    }
+    size_t block_size = get_u32(data + 4);
+    if (block_size < MIN_BLOCK_KB * 1024 || block_size > MAX_BLOCK_KB * 1024) {
+        printf("Ошибка: неверный размер блока %zu\n", block_size);
+        return 0;
+    }
+    memset(stats, 0, sizeof(BlockStats));
+    stats->input_size = size;
+    unsigned char* buffer = (unsigned char*)malloc(block_size);
+    size_t pos = STREAM_HEADER_SIZE;
+    int ok = 1;
+    double start = now_seconds();
+    for (int block = 0; pos < size; block++) {
+        if (size - pos < BLOCK_HEADER_SIZE) {
+            ok = 0;
+        } else {
+            int kind = data[pos];
+            size_t length = get_u32(data + pos + 1);
+            size_t payload_size = get_u32(data + pos + 5);
+            pos += BLOCK_HEADER_SIZE;
+            ok = length <= block_size && payload_size <= size - pos &&
+                 decode_block(kind, data + pos, payload_size, buffer, length);
+            if (ok) {
+                fwrite(buffer, 1, length, out);
+                stats->output_size += length;
+                stats->blocks[kind]++;
+                pos += payload_size;
+            }
+        }
+        if (!ok) {
+            printf("Ошибка: поврежден блок %d\n", block);
+            break;
+        }
+    }
+    stats->code_time = now_seconds() - start;
+    free(buffer);
+    return ok && !ferror(out);
+}
+
+// ---------------- Режимы ----------------
+
+int process_file(const char* input, const char* output, size_t block_size, int decode) {
+    MappedFile in;
+    if (!map_file(input, &in)) return 0;
+    FILE* out = fopen(output, "wb");
+    if (!out) {
+        printf("Ошибка: не удалось создать файл %s\n", output);
+        unmap_file(&in);
+        return 0;
+    }
+
+    BlockStats stats;
+    int ok = decode ? decode_data(in.data, in.size, out, &stats)
+                    : encode_data(in.data, in.size, block_size, out, &stats);
+    ok = (fclose(out) == 0) && ok;
+    unmap_file(&in);
+    if (!ok) {
+        printf("Ошибка обработки %s\n", input);
+        return 0;
+    }
+
+    if (decode) {
+        printf("Сжатый файл: %zu байт, восстановлено: %zu байт\n", stats.input_size, stats.output_size);
+    } else {
+        printf("Исходный файл: %zu байт, сжатый: %zu байт (%.2f%%)\n", stats.input_size, stats.output_size,
+               stats.input_size ? 100.0 * stats.output_size / stats.input_size : 0.0);
+    }
+    printf("Блоков: Шеннон %d, Фано %d, без сжатия %d; время: %.4f с\n",
+           stats.blocks[BLOCK_SHANNON], stats.blocks[BLOCK_FANO], stats.blocks[BLOCK_RAW], stats.code_time);
+    return 1;
+}
+
+int round_trip(int count, char* files[], size_t block_size) {
+    const char* headers[] = {"Файл", "Байт", "Один код, %", "Блоки, %", "Шеннон", "Фано", "Без сжатия", "Проверка"};
+    int widths[] = {30, 10, 11, 10, 7, 7, 10, 10};
+    const char* line = "+--------------------------------+------------+-------------+------------"
+                       "+---------+---------+------------+------------+\n";
+    printf("Размер блока: %zu КБ\n", block_size / 1024);
+    printf("%s", line);
+    for (int c = 0; c < 8; c++) print_cell(headers[c], widths[c]);
+    printf("|\n%s", line);
+
+    int all_ok = 1;
+    for (int f = 0; f < count; f++) {
+        MappedFile in;
+        if (!map_file(files[f], &in)) {
+            all_ok = 0;
+            continue;
+        }
+        // Один код на файл - тот же выбор способа, но для всего файла целиком
+        BlockPlan global;
+        plan_block(in.data, in.size, &global);
+        size_t global_size = STREAM_HEADER_SIZE + global.cost;
+
+        char* packed = NULL;
+        size_t packed_size = 0;
+        FILE* packed_stream = open_memstream(&packed, &packed_size);
+        BlockStats encode_stats;
+        int ok = encode_data(in.data, in.size, block_size, packed_stream, &encode_stats);
+        fclose(packed_stream);
+
+        char* restored = NULL;
+        size_t restored_size = 0;
+        FILE* restored_stream = open_memstream(&restored, &restored_size);
+        BlockStats decode_stats;
+        ok = ok && decode_data((const unsigned char*)packed, packed_size, restored_stream, &decode_stats);
+        fclose(restored_stream);
+        ok = ok && restored_size == in.size && (in.size == 0 || memcmp(restored, in.data, in.size) == 0);
+        all_ok = all_ok && ok;
+
+        print_cell(files[f], widths[0]);
+        printf("| %10zu | %11.2f | %10.2f | %7d | %7d | %10d ", in.size,
+               in.size ? 100.0 * global_size / in.size : 0.0,
+               in.size ? 100.0 * packed_size / in.size : 0.0,
+               encode_stats.blocks[BLOCK_SHANNON], encode_stats.blocks[BLOCK_FANO],
+               encode_stats.blocks[BLOCK_RAW]);
+        print_cell(ok ? "совпадает" : "ОШИБКА", widths[7]);
+        printf("|\n");
+
+        free(packed);
+        free(restored);
+        unmap_file(&in);
+    }
+    printf("%s", line);
+    return all_ok;
+}
+
+void print_usage(const char* program) {
+    printf("Использование:\n");
+    printf("  %s -e [-s размер блока, КБ] <исходный файл> <сжатый файл>\n", program);
+    printf("  %s -d <сжатый файл> <восстановленный файл>\n", program);
+    printf("  %s -t [-s размер блока, КБ] <файл>...\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const char* mode = argv[1];
+    size_t block_kb = DEFAULT_BLOCK_KB;
+    int first = 2;
+    if (argc > 3 && strcmp(argv[2], "-s") == 0) {
+        block_kb = (size_t)atol(argv[3]);
+        first = 4;
+    }
+    if (block_kb < MIN_BLOCK_KB || block_kb > MAX_BLOCK_KB) {
+        printf("Ошибка: размер блока должен быть от %d до %d КБ\n", MIN_BLOCK_KB, MAX_BLOCK_KB);
+        return 1;
+    }
+    size_t block_size = block_kb * 1024;
+    int rest = argc - first;
+
+    if (strcmp(mode, "-e") == 0 && rest == 2) {
+        return process_file(argv[first], argv[first + 1], block_size, 0) ? 0 : 1;
+    }
+    if (strcmp(mode, "-d") == 0 && first == 2 && rest == 2) {
+        return process_file(argv[first], argv[first + 1], block_size, 1) ? 0 : 1;
+    }
+    if (strcmp(mode, "-t") == 0 && rest >= 1) {
+        return round_trip(rest, argv + first, block_size) ? 0 : 1;
+    }
+    print_usage(argv[0]);
+    return 1;
+}
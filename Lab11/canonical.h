@@ -0,0 +1,399 @@
+#ifndef CANONICAL_H
+#define CANONICAL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Общее ядро канонических кодов для 1.c, block.c и order1.c: длины кодов Шеннона
+// и Фано, назначение канонических кодов, запись кодов, табличный декодер и чтение
+// битов с проверкой конца потока. Каждая программа собирается из одного .c файла,
+// поэтому функции определены прямо здесь.
+
+#define MAX_SYMBOLS 256
+// Коды длиннее не помещаются в буфер чтения после подкачки
+#define MAX_STREAM_CODE_LENGTH 56
+// Ширина первичной таблицы декодера; программа может задать свою до включения файла
+#ifndef DECODE_TABLE_BITS
+#define DECODE_TABLE_BITS 11
+#endif
+
+// ---------------- Файлы и вывод ----------------
+
+// Отображенный входной файл
+typedef struct MappedFile {
+    const unsigned char* data;
+    size_t size;
+} MappedFile;
+
+int map_file(const char* filename, MappedFile* file) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        printf("Ошибка: не удалось открыть файл %s\n", filename);
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        printf("Ошибка: не удалось получить размер файла %s\n", filename);
+        close(fd);
+        return 0;
+    }
+    file->size = (size_t)st.st_size;
+    file->data = NULL;
+    if (file->size > 0) {
+        void* map = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            printf("Ошибка: mmap %s не удался\n", filename);
+            close(fd);
+            return 0;
+        }
+        madvise(map, file->size, MADV_SEQUENTIAL);
+        file->data = (const unsigned char*)map;
+    }
+    close(fd);
+    return 1;
+}
+
+void unmap_file(MappedFile* file) {
+    if (file->size > 0) munmap((void*)file->data, file->size);
+}
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Ячейка таблицы шириной width символов: printf считает ширину в байтах, а
+// кириллица в UTF-8 занимает два байта на букву
+void print_cell(const char* text, int width) {
+    int length = 0;
+    for (const char* c = text; *c; c++) {
+        if ((*c & 0xC0) != 0x80) length++;
+    }
+    printf("| %s%*s ", text, width > length ? width - length : 0, "");
+}
+
+// ---------------- Длины кодов ----------------
+
+// Длины Шеннона ceil(-log2 p); единственный символ все равно занимает бит
+void shannon_lengths(const uint64_t* counts, uint64_t total, int* lengths) {
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        lengths[s] = 0;
+        if (counts[s] == 0) continue;
+        int length = (int)ceil(-log2((double)counts[s] / total));
+        lengths[s] = length < 1 ? 1 : length;
+    }
+}
+
+// Медианы Фано работают по префиксным суммам частот символов, упорядоченных по
+// убыванию частоты: prefix[i] - сумма частот символов 0..i-1, сумма на
+// [left, right] равна prefix[right + 1] - prefix[left]
+
+// Классическая медиана: наибольшее m из [left, right], при котором сумма [left, m-1]
+// меньше суммы [m, right], то есть 2 * prefix[m] < prefix[left] + prefix[right + 1]
+int median_classic(const uint64_t* prefix, int left, int right) {
+    uint64_t bound = prefix[left] + prefix[right + 1];
+    int lo = left, hi = right;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (2 * prefix[mid] < bound) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+
+// Медиана A2: первый символ, на котором накопленная сумма переходит через половину
+// отрезка; если половина достигается ровно на границе символов, медианой остается left
+int median_a2(const uint64_t* prefix, int left, int right) {
+    uint64_t total_weight = prefix[right + 1] - prefix[left];
+    int lo = left, hi = right;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (2 * (prefix[mid + 1] - prefix[left]) > total_weight) hi = mid;
+        else lo = mid + 1;
+    }
+    if (2 * (prefix[lo] - prefix[left]) < total_weight) return lo;
+    return left;
+}
+
+// Энтропийная медиана - наименьшая потеря информации при разбиении. Потеря считается
+// по частотам, а не по вероятностям: она отличается только положительным множителем,
+// и минимум достигается на той же медиане
+int median_entropy(const uint64_t* prefix, int left, int right) {
+    double total = (double)(prefix[right + 1] - prefix[left]);
+    double total_entropy = -total * log2(total);
+    double min_entropy_loss = 1e300;
+    int best_median = left;
+    for (int i = left; i < right; i++) {
+        double left_sum = (double)(prefix[i + 1] - prefix[left]);
+        double right_sum = total - left_sum;
+        double entropy_loss = total_entropy + left_sum * log2(left_sum) + right_sum * log2(right_sum);
+        if (entropy_loss < min_entropy_loss) {
+            min_entropy_loss = entropy_loss;
+            best_median = i;
+        }
+    }
+    return best_median;
+}
+
+// method: 0 - классическая медиана, 1 - A2, 2 - энтропийная
+int fano_median(const uint64_t* prefix, int left, int right, int method) {
+    if (method == 1) return median_a2(prefix, left, right);
+    if (method == 2) return median_entropy(prefix, left, right);
+    return median_classic(prefix, left, right);
+}
+
+void fano_split(const uint64_t* prefix, int* depth, int left, int right, int level, int method) {
+    if (left >= right) {
+        if (left == right) depth[left] = level;
+        return;
+    }
+    int median = fano_median(prefix, left, right, method);
+    fano_split(prefix, depth, left, median, level + 1, method);
+    fano_split(prefix, depth, median + 1, right, level + 1, method);
+}
+
+// Порядок символов в коде Фано: по убыванию частоты, при равенстве - по возрастанию символа
+static inline int goes_before(int a, int b, const uint64_t* counts) {
+    if (counts[a] != counts[b]) return counts[a] > counts[b];
+    return a < b;
+}
+
+// Длины Фано по частотам символов для method
+void fano_lengths(const uint64_t* counts, int method, int* lengths) {
+    int order[MAX_SYMBOLS];
+    int n = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        lengths[s] = 0;
+        if (counts[s] > 0) order[n++] = s;
+    }
+    if (n == 0) return;
+    // Сортировка вставками: символов не больше 256
+    for (int i = 1; i < n; i++) {
+        int s = order[i], j = i;
+        while (j > 0 && goes_before(s, order[j - 1], counts)) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = s;
+    }
+    uint64_t prefix[MAX_SYMBOLS + 1];
+    prefix[0] = 0;
+    for (int i = 0; i < n; i++) prefix[i + 1] = prefix[i] + counts[order[i]];
+
+    int depth[MAX_SYMBOLS];
+    fano_split(prefix, depth, 0, n - 1, 0, method);
+    for (int i = 0; i < n; i++) lengths[order[i]] = depth[i] > 0 ? depth[i] : 1;
+}
+
+uint64_t code_bits(const uint64_t* counts, const int* lengths) {
+    uint64_t bits = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) bits += counts[s] * (uint64_t)lengths[s];
+    return bits;
+}
+
+int max_length(const int* lengths) {
+    int longest = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (lengths[s] > longest) longest = lengths[s];
+    }
+    return longest;
+}
+
+// ---------------- Канонические коды ----------------
+
+// Канонические коды: внутри одной длины коды идут по возрастанию символа.
+// Возвращает 0, если длина больше MAX_STREAM_CODE_LENGTH или длины нарушают
+// неравенство Крафта
+int canonical_codes(const int* lengths, uint64_t* codes) {
+    int length_count[MAX_STREAM_CODE_LENGTH + 1] = {0};
+    uint64_t next_code[MAX_STREAM_CODE_LENGTH + 1] = {0};
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (lengths[s] < 0 || lengths[s] > MAX_STREAM_CODE_LENGTH) return 0;
+        if (lengths[s] > 0) length_count[lengths[s]]++;
+    }
+    uint64_t code = 0;
+    for (int length = 1; length <= MAX_STREAM_CODE_LENGTH; length++) {
+        code = (code + length_count[length - 1]) << 1;
+        next_code[length] = code;
+        if (code + length_count[length] > (1ULL << length)) return 0;
+    }
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        codes[s] = (lengths[s] > 0) ? next_code[lengths[s]]++ : 0;
+    }
+    return 1;
+}
+
+// Пишет коды символов data в out (старший бит - первым), хвост добивается нулями
+// до байта. Возвращает число записанных байт; out - не меньше
+// size * максимальная длина / 8 + 8 байт
+size_t encode_symbols(const unsigned char* data, size_t size, const int* lengths, unsigned char* out) {
+    uint64_t codes[MAX_SYMBOLS];
+    canonical_codes(lengths, codes);
+    // Код и длина в одном слове: одна загрузка на символ
+    uint64_t table[MAX_SYMBOLS];
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        table[s] = (codes[s] << 8) | (uint64_t)lengths[s];
+    }
+    size_t used = 0;
+    uint64_t buffer = 0;
+    int count = 0;
+    for (size_t i = 0; i < size; i++) {
+        uint64_t entry = table[data[i]];
+        int length = (int)(entry & 0xFF);
+        buffer = (buffer << length) | (entry >> 8);
+        count += length;
+        while (count >= 8) {
+            count -= 8;
+            out[used++] = (unsigned char)(buffer >> count);
+        }
+    }
+    if (count > 0) out[used++] = (unsigned char)(buffer << (8 - count));
+    return used;
+}
+
+// ---------------- Декодирование ----------------
+
+// Таблица по первым DECODE_TABLE_BITS битам дает символ и длину его кода;
+// length = 0 - код длиннее, он ищется по каноническим границам длин
+typedef struct DecodeEntry {
+    uint8_t symbol;
+    uint8_t length;
+} DecodeEntry;
+
+typedef struct Decoder {
+    DecodeEntry table[1 << DECODE_TABLE_BITS];
+    // Коды длины L - это first_code[L] .. first_code[L] + length_count[L] - 1,
+    // их символы лежат в sorted_symbols начиная с first_index[L]
+    uint64_t first_code[MAX_STREAM_CODE_LENGTH + 1];
+    int length_count[MAX_STREAM_CODE_LENGTH + 1];
+    int first_index[MAX_STREAM_CODE_LENGTH + 1];
+    unsigned char sorted_symbols[MAX_SYMBOLS];
+    int max_length;
+} Decoder;
+
+// Возвращает 0, если по длинам нельзя построить префиксный код
+int decoder_init(Decoder* d, const int* lengths) {
+    uint64_t codes[MAX_SYMBOLS];
+    if (!canonical_codes(lengths, codes)) return 0;
+    const int K = DECODE_TABLE_BITS;
+
+    memset(d, 0, sizeof(Decoder));
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (lengths[s] > 0) d->length_count[lengths[s]]++;
+    }
+    d->max_length = max_length(lengths);
+    int index = 0;
+    for (int length = 1; length <= MAX_STREAM_CODE_LENGTH; length++) {
+        d->first_index[length] = index;
+        for (int s = 0; s < MAX_SYMBOLS; s++) {
+            if (lengths[s] != length) continue;
+            if (index == d->first_index[length]) d->first_code[length] = codes[s];
+            d->sorted_symbols[index++] = (unsigned char)s;
+        }
+    }
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        int length = lengths[s];
+        if (length == 0 || length > K) continue;
+        uint32_t first = (uint32_t)(codes[s] << (K - length));
+        for (uint32_t e = 0; e < (1u << (K - length)); e++) {
+            d->table[first + e] = (DecodeEntry){(uint8_t)s, (uint8_t)length};
+        }
+    }
+    return 1;
+}
+
+// Медленный путь для длинных кодов
+static inline int decode_slow(const Decoder* d, uint64_t bits, int* length) {
+    for (int l = DECODE_TABLE_BITS + 1; l <= d->max_length; l++) {
+        uint64_t code = (bits >> (64 - l)) - d->first_code[l];
+        if (code < (uint64_t)d->length_count[l]) {
+            *length = l;
+            return d->sorted_symbols[d->first_index[l] + code];
+        }
+    }
+    return -1;
+}
+
+// Непрочитанные биты выровнены по старшему краю; за концом потока идут нули,
+// padding считает, сколько таких бит подставлено
+typedef struct BitReader {
+    const unsigned char* p;
+    const unsigned char* end;
+    uint64_t bits;
+    int count;
+    int padding;
+} BitReader;
+
+void reader_init(BitReader* r, const unsigned char* data, size_t size) {
+    r->p = data;
+    r->end = data + size;
+    r->bits = 0;
+    r->count = 0;
+    r->padding = 0;
+}
+
+// После подкачки в буфере не меньше MAX_STREAM_CODE_LENGTH бит
+static inline void reader_refill(BitReader* r) {
+    if (r->count > MAX_STREAM_CODE_LENGTH) return;
+    if (r->end - r->p >= 8) {
+        uint64_t word;
+        memcpy(&word, r->p, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+        // Берутся целые байты, которые помещаются в буфер
+        r->bits |= word >> r->count;
+        r->p += (63 - r->count) >> 3;
+        r->count |= 56;
+    } else {
+        while (r->count <= 56) {
+            if (r->p < r->end) r->bits |= (uint64_t)*r->p++ << (56 - r->count);
+            else r->padding += 8;
+            r->count += 8;
+        }
+    }
+}
+
+// length от 1 до 32
+static inline uint32_t reader_get(BitReader* r, int length) {
+    reader_refill(r);
+    uint32_t value = (uint32_t)(r->bits >> (64 - length));
+    r->bits <<= length;
+    r->count -= length;
+    return value;
+}
+
+// Прочитанные нули дополнения означают, что поток обрезан
+static inline int reader_overrun(const BitReader* r) {
+    return r->padding > r->count;
+}
+
+#define DECODE_INVALID (-1)
+#define DECODE_TRUNCATED (-2)
+
+// Следующий символ потока, DECODE_INVALID для неверной кодовой последовательности
+// или DECODE_TRUNCATED, если код заходит в нули за концом потока
+static inline int decode_symbol(const Decoder* d, BitReader* r) {
+    reader_refill(r);
+    DecodeEntry e = d->table[r->bits >> (64 - DECODE_TABLE_BITS)];
+    int symbol = e.symbol, length = e.length;
+    if (length == 0) {
+        symbol = decode_slow(d, r->bits, &length);
+        if (symbol < 0) return DECODE_INVALID;
+    }
+    r->bits <<= length;
+    r->count -= length;
+    if (reader_overrun(r)) return DECODE_TRUNCATED;
+    return symbol;
+}
+
+#endif
@@ -0,0 +1,396 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// Канонический код Хаффмана с ограничением длины кода.
+// Оптимальные длины без ограничения: сортировка весов и слияние двух очередей, O(n log n).
+// Длины не больше limit: алгоритм package-merge - на каждом из limit уровней пары
+// соседних элементов упаковываются и сливаются с листьями, из последнего списка
+// берутся первые 2n-2 элемента, и длина символа - число его вхождений в них.
+// Коды назначаются канонически, поэтому хранить нужно только длины, а при
+// ограничении limit декодирование идет одной таблицей из 2^limit элементов.
+// Сборка: gcc -O2 huffman.c -o huffman -lm
+// Запуск: ./huffman <имя_файла> [ограничение длины]
+
+#define MAX_SYMBOLS 256
+// Код Хаффмана длиннее 50 бит требует весов порядка чисел Фибоначчи, то есть
+// файла больше 10^10 байт; такие длины отвергает assign_canonical_codes
+#define MAX_CODE_LENGTH 50
+#define DEFAULT_LENGTH_LIMIT 12
+// Таблица декодирования - 2^limit элементов по 4 байта: при 16 это 256 КБ,
+// а при 32 уже 16 ГБ, которые malloc не выделит
+#define MAX_LENGTH_LIMIT 16
+
+typedef struct {
+    unsigned char symbol;
+    long long frequency;
+    double probability;
+    int code_length;
+    uint64_t code;
+} SymbolInfo;
+
+typedef struct {
+    SymbolInfo symbols[MAX_SYMBOLS];
+    int count;
+    double kraft_sum;
+    double entropy;
+    double avg_length;
+    double redundancy;
+} HuffmanCode;
+
+// Элемент списка package-merge: лист (symbol >= 0) или пакет из двух элементов
+// предыдущего уровня (symbol = -1)
+typedef struct {
+    long long weight;
+    int symbol;
+} MergeItem;
+
+int compare_by_frequency(const void* a, const void* b) {
+    const SymbolInfo* sa = (const SymbolInfo*)a;
+    const SymbolInfo* sb = (const SymbolInfo*)b;
+    if (sa->frequency != sb->frequency) return (sa->frequency < sb->frequency) ? -1 : 1;
+    return (int)sa->symbol - (int)sb->symbol;
+}
+
+// Хаффман без ограничения. symbols упорядочены по возрастанию частоты; листья и
+// внутренние узлы берутся из двух очередей, которые обе остаются упорядоченными
+void huffman_lengths(SymbolInfo* symbols, int n) {
+    if (n == 1) {
+        symbols[0].code_length = 1;
+        return;
+    }
+    long long weight[2 * MAX_SYMBOLS];
+    int parent[2 * MAX_SYMBOLS];
+    for (int i = 0; i < n; i++) weight[i] = symbols[i].frequency;
+
+    int leaf = 0, inner = n, next = n;
+    for (int step = 0; step < n - 1; step++) {
+        int pick[2];
+        for (int k = 0; k < 2; k++) {
+            if (leaf < n && (inner >= next || weight[leaf] <= weight[inner])) pick[k] = leaf++;
+            else pick[k] = inner++;
+        }
+        weight[next] = weight[pick[0]] + weight[pick[1]];
+        parent[pick[0]] = next;
+        parent[pick[1]] = next;
+        next++;
+    }
+
+    // Корень - последний узел; глубина узла на 1 больше глубины родителя
+    int depth[2 * MAX_SYMBOLS];
+    depth[next - 1] = 0;
+    for (int v = next - 2; v >= 0; v--) depth[v] = depth[parent[v]] + 1;
+    for (int i = 0; i < n; i++) symbols[i].code_length = depth[i];
+}
+
+// Package-merge: symbols упорядочены по возрастанию частоты, 2^limit >= n
+void package_merge_lengths(SymbolInfo* symbols, int n, int limit) {
+    if (n == 1) {
+        symbols[0].code_length = 1;
+        return;
+    }
+    MergeItem* lists[MAX_CODE_LENGTH + 1];
+    int sizes[MAX_CODE_LENGTH + 1];
+
+    lists[1] = (MergeItem*)malloc(n * sizeof(MergeItem));
+    for (int i = 0; i < n; i++) lists[1][i] = (MergeItem){symbols[i].frequency, i};
+    sizes[1] = n;
+
+    for (int level = 2; level <= limit; level++) {
+        MergeItem* prev = lists[level - 1];
+        int packages = sizes[level - 1] / 2;
+        lists[level] = (MergeItem*)malloc((n + packages) * sizeof(MergeItem));
+        int i = 0, p = 0, k = 0;
+        while (i < n || p < packages) {
+            long long package = (p < packages) ? prev[2 * p].weight + prev[2 * p + 1].weight : 0;
+            if (p >= packages || (i < n && symbols[i].frequency <= package)) {
+                lists[level][k++] = (MergeItem){symbols[i].frequency, i};
+                i++;
+            } else {
+                lists[level][k++] = (MergeItem){package, -1};
+                p++;
+            }
+        }
+        sizes[level] = k;
+    }
+
+    // Берем первые 2n-2 элемента верхнего списка; каждый пакет в них раскрывается
+    // в пару элементов уровнем ниже, поэтому там берется 2 * (число пакетов)
+    for (int i = 0; i < n; i++) symbols[i].code_length = 0;
+    int take = 2 * n - 2;
+    for (int level = limit; level >= 1 && take > 0; level--) {
+        int packages = 0;
+        for (int k = 0; k < take; k++) {
+            if (lists[level][k].symbol >= 0) symbols[lists[level][k].symbol].code_length++;
+            else packages++;
+        }
+        take = 2 * packages;
+    }
+
+    for (int level = 1; level <= limit; level++) free(lists[level]);
+}
+
+// Канонические коды по возрастанию (длина, символ).
+// Возвращает 0, если какой-то код длиннее MAX_CODE_LENGTH
+int assign_canonical_codes(SymbolInfo* symbols, int n) {
+    int length_count[MAX_CODE_LENGTH + 1] = {0};
+    uint64_t next_code[MAX_CODE_LENGTH + 1] = {0};
+    for (int i = 0; i < n; i++) {
+        if (symbols[i].code_length > MAX_CODE_LENGTH) return 0;
+        length_count[symbols[i].code_length]++;
+    }
+    uint64_t code = 0;
+    length_count[0] = 0;
+    for (int length = 1; length <= MAX_CODE_LENGTH; length++) {
+        code = (code + length_count[length - 1]) << 1;
+        next_code[length] = code;
+    }
+    // Внутри одной длины коды идут по возрастанию символа
+    uint64_t* by_symbol[MAX_SYMBOLS] = {0};
+    for (int i = 0; i < n; i++) by_symbol[symbols[i].symbol] = &symbols[i].code;
+    int length_of[MAX_SYMBOLS] = {0};
+    for (int i = 0; i < n; i++) length_of[symbols[i].symbol] = symbols[i].code_length;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (by_symbol[s] != NULL) *by_symbol[s] = next_code[length_of[s]]++;
+    }
+    return 1;
+}
+
+void calculate_metrics(HuffmanCode* code) {
+    code->kraft_sum = 0;
+    code->entropy = 0;
+    code->avg_length = 0;
+    for (int i = 0; i < code->count; i++) {
+        SymbolInfo* s = &code->symbols[i];
+        code->kraft_sum += pow(2, -s->code_length);
+        code->entropy -= s->probability * log2(s->probability);
+        code->avg_length += s->probability * s->code_length;
+    }
+    code->redundancy = code->avg_length - code->entropy;
+}
+
+// ---------------- Кодирование и декодирование ----------------
+
+typedef struct {
+    uint16_t symbol;
+    uint16_t length;
+} DecodeEntry;
+
+// Кодирует data в out (старший бит - первым), возвращает число байт
+size_t encode_buffer(const unsigned char* data, size_t size, const uint64_t* table, unsigned char* out) {
+    uint64_t buffer = 0;
+    int count = 0;
+    size_t used = 0;
+    for (size_t i = 0; i < size; i++) {
+        uint64_t entry = table[data[i]];
+        int length = (int)(entry & 0xFF);
+        buffer = (buffer << length) | (entry >> 8);
+        count += length;
+        while (count >= 8) {
+            count -= 8;
+            out[used++] = (unsigned char)(buffer >> count);
+        }
+    }
+    if (count > 0) out[used++] = (unsigned char)(buffer << (8 - count));
+    return used;
+}
+
+// Одна таблица по limit битам: длина кода не больше limit, поэтому второго уровня нет
+void decode_buffer(const unsigned char* in, size_t in_size, const DecodeEntry* table, int limit,
+                   unsigned char* out, size_t size) {
+    uint64_t buffer = 0;
+    int count = 0;
+    size_t pos = 0;
+    for (size_t i = 0; i < size; i++) {
+        while (count <= 56) {
+            buffer |= (uint64_t)(pos < in_size ? in[pos] : 0) << (56 - count);
+            pos++;
+            count += 8;
+        }
+        DecodeEntry e = table[buffer >> (64 - limit)];
+        out[i] = (unsigned char)e.symbol;
+        buffer <<= e.length;
+        count -= e.length;
+    }
+}
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// ---------------- Вывод ----------------
+
+void print_code_table(HuffmanCode* code, const char* method_name) {
+    printf("\n%s\n", method_name);
+    printf("Символ\t\tВероятность\tКодовое слово\t\tДлина\n");
+    printf("------------------------------------------------------------\n");
+    // Самые частые символы - в конце массива
+    int shown = 0;
+    for (int i = code->count - 1; i >= 0 && shown < 20; i--, shown++) {
+        SymbolInfo* s = &code->symbols[i];
+        if (s->symbol >= 0xC0 && s->symbol <= 0xDF) {
+            printf("RU-0x%02X\t", s->symbol);
+        } else if (s->symbol >= 32 && s->symbol <= 126) {
+            printf("'%c'\t\t", s->symbol);
+        } else {
+            printf("0x%02X\t\t", s->symbol);
+        }
+        char bits[MAX_CODE_LENGTH + 1];
+        for (int b = 0; b < s->code_length; b++) {
+            bits[b] = ((s->code >> (s->code_length - 1 - b)) & 1) ? '1' : '0';
+        }
+        bits[s->code_length] = '\0';
+        printf("%.6f\t%-20s\t%d\n", s->probability, bits, s->code_length);
+    }
+    if (code->count > 20) {
+        printf("... (и еще %d символов)\n", code->count - 20);
+    }
+}
+
+void print_analysis_results(HuffmanCode* code, const char* method_name) {
+    printf("\nАнализ %s\n", method_name);
+    printf("------------------------------------------------------------\n");
+    printf("Неравенство Крафта:\t%.6f\n", code->kraft_sum);
+    printf("Энтропия:\t\t%.6f\n", code->entropy);
+    printf("Средняя длина:\t\t%.6f\n", code->avg_length);
+    printf("Избыточность:\t\t%.6f\n", code->redundancy);
+    if (code->kraft_sum <= 1.0 + 1e-10) {
+        printf("✓ Неравенство Крафта выполняется\n");
+    } else {
+        printf("✗ Неравенство Крафта не выполняется\n");
+    }
+    printf("Эффективность:\t\t%.2f%%\n", (code->entropy / code->avg_length) * 100);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        printf("Использование: %s <имя_файла> [ограничение длины]\n", argv[0]);
+        return 1;
+    }
+    const char* filename = argv[1];
+    int limit = (argc > 2) ? atoi(argv[2]) : DEFAULT_LENGTH_LIMIT;
+
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        printf("Ошибка: не удалось открыть файл %s\n", filename);
+        return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* data = (unsigned char*)malloc(file_size > 0 ? file_size : 1);
+    size_t size = fread(data, 1, file_size, file);
+    fclose(file);
+    if (size == 0) {
+        printf("Ошибка: файл %s пуст\n", filename);
+        free(data);
+        return 1;
+    }
+
+    long long frequencies[MAX_SYMBOLS] = {0};
+    for (size_t i = 0; i < size; i++) frequencies[data[i]]++;
+
+    HuffmanCode full, limited;
+    full.count = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (frequencies[s] == 0) continue;
+        SymbolInfo* info = &full.symbols[full.count++];
+        info->symbol = (unsigned char)s;
+        info->frequency = frequencies[s];
+        info->probability = (double)frequencies[s] / size;
+        info->code_length = 0;
+        info->code = 0;
+    }
+    qsort(full.symbols, full.count, sizeof(SymbolInfo), compare_by_frequency);
+    limited = full;
+
+    // 2^limit должно вмещать все символы
+    int min_limit = 1;
+    while ((1 << min_limit) < full.count) min_limit++;
+    if (limit < min_limit) limit = min_limit;
+    if (limit > MAX_LENGTH_LIMIT) limit = MAX_LENGTH_LIMIT;
+
+    printf("Размер файла: %zu байт\n", size);
+    printf("Обнаружено %d уникальных символов, ограничение длины кода: %d\n", full.count, limit);
+
+    huffman_lengths(full.symbols, full.count);
+    if (!assign_canonical_codes(full.symbols, full.count)) {
+        printf("Ошибка: код Хаффмана длиннее %d бит\n", MAX_CODE_LENGTH);
+        free(data);
+        return 1;
+    }
+    calculate_metrics(&full);
+
+    double start = now_seconds();
+    package_merge_lengths(limited.symbols, limited.count, limit);
+    assign_canonical_codes(limited.symbols, limited.count);
+    double build_time = now_seconds() - start;
+    calculate_metrics(&limited);
+
+    int max_full = 0;
+    for (int i = 0; i < full.count; i++) {
+        if (full.symbols[i].code_length > max_full) max_full = full.symbols[i].code_length;
+    }
+
+    char limited_name[64];
+    snprintf(limited_name, sizeof(limited_name), "Код Хаффмана (длина <= %d)", limit);
+    print_code_table(&full, "Код Хаффмана");
+    print_analysis_results(&full, "Код Хаффмана");
+    printf("Наибольшая длина кода:\t%d\n", max_full);
+    print_code_table(&limited, limited_name);
+    print_analysis_results(&limited, limited_name);
+    printf("Построение package-merge: %.6f с\n", build_time);
+
+    // Сжатие и восстановление файла ограниченным кодом
+    uint64_t encode_table[MAX_SYMBOLS] = {0};
+    DecodeEntry* decode_table = (DecodeEntry*)malloc(((size_t)1 << limit) * sizeof(DecodeEntry));
+    if (!decode_table) {
+        printf("Ошибка: не хватает памяти на таблицу декодирования\n");
+        free(data);
+        return 1;
+    }
+    for (int i = 0; i < limited.count; i++) {
+        SymbolInfo* s = &limited.symbols[i];
+        encode_table[s->symbol] = (s->code << 8) | (uint64_t)s->code_length;
+        uint64_t first = s->code << (limit - s->code_length);
+        for (uint64_t e = 0; e < (1ULL << (limit - s->code_length)); e++) {
+            decode_table[first + e] = (DecodeEntry){s->symbol, (uint16_t)s->code_length};
+        }
+    }
+    unsigned char* packed = (unsigned char*)malloc(size * ((size_t)limit + 7) / 8 + 8);
+    unsigned char* restored = (unsigned char*)malloc(size);
+    start = now_seconds();
+    size_t packed_size = encode_buffer(data, size, encode_table, packed);
+    double encode_time = now_seconds() - start;
+    start = now_seconds();
+    decode_buffer(packed, packed_size, decode_table, limit, restored, size);
+    double decode_time = now_seconds() - start;
+    int same = memcmp(restored, data, size) == 0;
+
+    printf("\nСРАВНЕНИЕ С ОПТИМУМОМ\n");
+    printf("============================================\n");
+    printf("Метод\t\t\t\tСредняя длина\tИзбыточность\tЭффективность\n");
+    printf("------------------------------------------------------------\n");
+    printf("%-30s\t%.6f\t%.6f\t%.2f%%\n", "Хаффман", full.avg_length, full.redundancy,
+           (full.entropy / full.avg_length) * 100);
+    printf("%-30s\t%.6f\t%.6f\t%.2f%%\n", limited_name, limited.avg_length, limited.redundancy,
+           (limited.entropy / limited.avg_length) * 100);
+    printf("Потеря от ограничения длины: %.6f бит/символ\n", limited.avg_length - full.avg_length);
+    printf("\nСжатый размер: %zu байт (%.2f%%), таблица декодирования: %zu байт\n",
+           packed_size, 100.0 * packed_size / size, ((size_t)1 << limit) * sizeof(DecodeEntry));
+    printf("Кодирование: %.1f МБ/с, декодирование: %.1f МБ/с, восстановление: %s\n",
+           encode_time > 0 ? size / 1048576.0 / encode_time : 0.0,
+           decode_time > 0 ? size / 1048576.0 / decode_time : 0.0,
+           same ? "совпадает" : "ОШИБКА");
+
+    free(decode_table);
+    free(packed);
+    free(restored);
+    free(data);
+    return same ? 0 : 1;
+}
@@ -0,0 +1,495 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// Декодеров до 257 - по одному на контекст, поэтому их таблицы меньше обычных
+#define DECODE_TABLE_BITS 9
+#include "canonical.h"
+
+// Модель первого порядка для кодов Шеннона и Фано: код очередного байта выбирается
+// по предыдущему байту (контексту). В UTF-8 кириллическая буква - два байта: после
+// 0xD0 идут только а-п, после 0xD1 - р-я, а после второго байта почти всегда снова
+// 0xD0/0xD1 или пробел, поэтому у таких контекстов коды короткие. Если байты
+// перемешаны и пары разорваны (real_russian.txt), H1 почти равна H0 и выигрыша нет.
+// Для каждого контекста строится своя таблица длин (лучший из кодов Шеннона и трех
+// медиан Фано, как в block.c), но только если она окупает место в заголовке;
+// редкие контексты кодируются общим кодом нулевого порядка.
+// Формат: "ORD1", исходный размер (8 байт), затем поток битов (старший бит - первым):
+//   таблица нулевого порядка, режим каждого из 256 контекстов (2 бита:
+//   0 - не встречается, 1 - общий код, 2 - своя таблица), таблицы контекстов, коды.
+// Таблица: число символов - 1 (8 бит), символы (по 8 бит, если их меньше 32,
+// иначе битовая карта из 256 бит), затем длины кодов по 6 бит в порядке символов.
+// Коды канонические. Контекст первого байта - 0.
+// Сборка: gcc -O2 order1.c -o order1 -lm
+// Запуск: ./order1 -e <исходный файл> <сжатый файл>
+//         ./order1 -d <сжатый файл> <восстановленный файл>
+//         ./order1 -t <файл>...   (сравнение с нулевым порядком и энтропией)
+
+#define LENGTH_BITS 6
+#define SYMBOL_LIST_LIMIT 32
+
+#define STREAM_MAGIC "ORD1"
+#define STREAM_HEADER_SIZE 12
+
+enum ContextMode { CONTEXT_UNUSED = 0, CONTEXT_ORDER0 = 1, CONTEXT_OWN = 2 };
+
+typedef struct ContextModel {
+    int order0[MAX_SYMBOLS];
+    int modes[MAX_SYMBOLS];
+    int lengths[MAX_SYMBOLS][MAX_SYMBOLS];  // у контекстов со своей таблицей
+    uint64_t header_bits;
+    uint64_t data_bits;
+    int own_tables;
+    int shared_contexts;
+} ContextModel;
+
+// ---------------- Длины кодов ----------------
+
+// Самый короткий из кодов Шеннона и Фано; возвращает число бит кодов
+uint64_t best_lengths(const uint64_t* counts, int* lengths) {
+    uint64_t total = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) total += counts[s];
+    uint64_t best = UINT64_MAX;
+    int candidate[MAX_SYMBOLS];
+    for (int variant = 0; variant < 4; variant++) {
+        if (variant == 0) shannon_lengths(counts, total, candidate);
+        else fano_lengths(counts, variant - 1, candidate);
+        int fits = 1;
+        for (int s = 0; s < MAX_SYMBOLS; s++) {
+            if (candidate[s] > MAX_STREAM_CODE_LENGTH) fits = 0;
+        }
+        uint64_t bits = code_bits(counts, candidate);
+        if (fits && bits < best) {
+            best = bits;
+            memcpy(lengths, candidate, sizeof(candidate));
+        }
+    }
+    return best;
+}
+
+// Размер таблицы длин в заголовке, бит
+uint64_t table_bits(const int* lengths) {
+    int present = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (lengths[s] > 0) present++;
+    }
+    uint64_t symbols = (present < SYMBOL_LIST_LIMIT) ? 8 * (uint64_t)present : MAX_SYMBOLS;
+    return 8 + symbols + LENGTH_BITS * (uint64_t)present;
+}
+
+// ---------------- Модель ----------------
+
+// Частоты пар (предыдущий байт, байт); с allow_order1 = 0 все контексты
+// получают общий код - это модель нулевого порядка в том же формате
+void build_model(const unsigned char* data, size_t size, int allow_order1, ContextModel* model) {
+    uint64_t (*counts)[MAX_SYMBOLS] = calloc(MAX_SYMBOLS, sizeof(*counts));
+    uint64_t order0[MAX_SYMBOLS] = {0};
+    int previous = 0;
+    for (size_t i = 0; i < size; i++) {
+        counts[previous][data[i]]++;
+        previous = data[i];
+    }
+    for (int c = 0; c < MAX_SYMBOLS; c++) {
+        for (int s = 0; s < MAX_SYMBOLS; s++) order0[s] += counts[c][s];
+    }
+
+    memset(model->order0, 0, sizeof(model->order0));
+    model->header_bits = 0;
+    model->data_bits = 0;
+    model->own_tables = 0;
+    model->shared_contexts = 0;
+    if (size == 0) {
+        memset(model->modes, 0, sizeof(model->modes));
+        free(counts);
+        return;
+    }
+    best_lengths(order0, model->order0);
+    model->header_bits = table_bits(model->order0) + 2 * MAX_SYMBOLS;
+
+    for (int c = 0; c < MAX_SYMBOLS; c++) {
+        uint64_t total = 0;
+        for (int s = 0; s < MAX_SYMBOLS; s++) total += counts[c][s];
+        if (total == 0) {
+            model->modes[c] = CONTEXT_UNUSED;
+            continue;
+        }
+        uint64_t shared = code_bits(counts[c], model->order0);
+        model->modes[c] = CONTEXT_ORDER0;
+        if (allow_order1) {
+            uint64_t own = best_lengths(counts[c], model->lengths[c]);
+            uint64_t own_table = table_bits(model->lengths[c]);
+            // Своя таблица должна окупить место, которое она занимает в заголовке
+            if (own + own_table < shared) {
+                model->modes[c] = CONTEXT_OWN;
+                model->header_bits += own_table;
+                model->data_bits += own;
+                model->own_tables++;
+                continue;
+            }
+        }
+        model->data_bits += shared;
+        model->shared_contexts++;
+    }
+    free(counts);
+}
+
+size_t model_size(const ContextModel* model) {
+    return STREAM_HEADER_SIZE + (size_t)((model->header_bits + model->data_bits + 7) / 8);
+}
+
+// ---------------- Запись битов ----------------
+
+#define OUTPUT_BUFFER_SIZE (1 << 16)
+
+typedef struct BitWriter {
+    uint64_t buffer;
+    int count;
+    unsigned char out[OUTPUT_BUFFER_SIZE];
+    size_t used;
+    FILE* file;
+    size_t written;
+} BitWriter;
+
+void writer_init(BitWriter* w, FILE* file) {
+    w->buffer = 0;
+    w->count = 0;
+    w->used = 0;
+    w->file = file;
+    w->written = 0;
+}
+
+void writer_flush(BitWriter* w) {
+    fwrite(w->out, 1, w->used, w->file);
+    w->written += w->used;
+    w->used = 0;
+}
+
+// length не больше MAX_STREAM_CODE_LENGTH: в буфере остается меньше 8 бит
+static inline void writer_put(BitWriter* w, uint64_t bits, int length) {
+    w->buffer = (w->buffer << length) | bits;
+    w->count += length;
+    while (w->count >= 8) {
+        w->count -= 8;
+        w->out[w->used++] = (unsigned char)(w->buffer >> w->count);
+        if (w->used == OUTPUT_BUFFER_SIZE) writer_flush(w);
+    }
+}
+
+// Остаток добивается нулями до целого байта
+void writer_finish(BitWriter* w) {
+    if (w->count > 0) writer_put(w, 0, 8 - w->count);
+    writer_flush(w);
+}
+
+void write_table(BitWriter* w, const int* lengths) {
+    int present = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (lengths[s] > 0) present++;
+    }
+    writer_put(w, (uint64_t)(present - 1), 8);
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (present < SYMBOL_LIST_LIMIT) {
+            if (lengths[s] > 0) writer_put(w, (uint64_t)s, 8);
+        } else {
+            writer_put(w, lengths[s] > 0, 1);
+        }
+    }
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (lengths[s] > 0) writer_put(w, (uint64_t)lengths[s], LENGTH_BITS);
+    }
+}
+
+// ---------------- Кодирование ----------------
+
+typedef struct CodecStats {
+    size_t input_size;
+    size_t output_size;
+    double code_time;
+} CodecStats;
+
+int encode_data(const unsigned char* data, size_t size, FILE* out, CodecStats* stats, ContextModel* model) {
+    build_model(data, size, 1, model);
+
+    unsigned char header[STREAM_HEADER_SIZE];
+    memcpy(header, STREAM_MAGIC, 4);
+    for (int b = 0; b < 8; b++) header[4 + b] = (unsigned char)((uint64_t)size >> (8 * b));
+    fwrite(header, 1, STREAM_HEADER_SIZE, out);
+
+    BitWriter* w = (BitWriter*)malloc(sizeof(BitWriter));
+    writer_init(w, out);
+    // Код и длина в одном слове: одна загрузка на символ
+    uint64_t (*table)[MAX_SYMBOLS] = malloc(MAX_SYMBOLS * sizeof(*table));
+    double start = now_seconds();
+    if (size > 0) {
+        write_table(w, model->order0);
+        for (int c = 0; c < MAX_SYMBOLS; c++) writer_put(w, (uint64_t)model->modes[c], 2);
+        for (int c = 0; c < MAX_SYMBOLS; c++) {
+            if (model->modes[c] == CONTEXT_OWN) write_table(w, model->lengths[c]);
+        }
+
+        uint64_t codes[MAX_SYMBOLS];
+        for (int c = 0; c < MAX_SYMBOLS; c++) {
+            if (model->modes[c] == CONTEXT_UNUSED) continue;
+            const int* lengths = (model->modes[c] == CONTEXT_OWN) ? model->lengths[c] : model->order0;
+            canonical_codes(lengths, codes);
+            for (int s = 0; s < MAX_SYMBOLS; s++) table[c][s] = (codes[s] << 8) | (uint64_t)lengths[s];
+        }
+        int previous = 0;
+        for (size_t i = 0; i < size; i++) {
+            uint64_t entry = table[previous][data[i]];
+            writer_put(w, entry >> 8, (int)(entry & 0xFF));
+            previous = data[i];
+        }
+    }
+    writer_finish(w);
+    stats->code_time = now_seconds() - start;
+    stats->input_size = size;
+    stats->output_size = STREAM_HEADER_SIZE + w->written;
+    free(table);
+    free(w);
+    return !ferror(out);
+}
+
+// ---------------- Декодирование ----------------
+
+int read_table(BitReader* r, int* lengths) {
+    memset(lengths, 0, MAX_SYMBOLS * sizeof(int));
+    int present = (int)reader_get(r, 8) + 1;
+    int symbols[MAX_SYMBOLS];
+    if (present < SYMBOL_LIST_LIMIT) {
+        for (int i = 0; i < present; i++) {
+            symbols[i] = (int)reader_get(r, 8);
+            if (i > 0 && symbols[i] <= symbols[i - 1]) return 0;
+        }
+    } else {
+        int n = 0;
+        for (int s = 0; s < MAX_SYMBOLS; s++) {
+            if (reader_get(r, 1)) symbols[n++] = s;
+        }
+        if (n != present) return 0;
+    }
+    for (int i = 0; i < present; i++) {
+        int length = (int)reader_get(r, LENGTH_BITS);
+        if (length == 0 || length > MAX_STREAM_CODE_LENGTH) return 0;
+        lengths[symbols[i]] = length;
+    }
+    return !reader_overrun(r);
+}
+
+int decode_data(const unsigned char* data, size_t size, FILE* out, CodecStats* stats) {
+    if (size < STREAM_HEADER_SIZE || memcmp(data, STREAM_MAGIC, 4) != 0) {
+        printf("Ошибка: файл не является сжатым файлом первого порядка\n");
+        return 0;
+    }
+    uint64_t original_size = 0;
+    for (int b = 0; b < 8; b++) original_size |= (uint64_t)data[4 + b] << (8 * b);
+    stats->input_size = size;
+    stats->output_size = (size_t)original_size;
+    stats->code_time = 0;
+    if (original_size == 0) return 1;
+    // Каждый символ занимает хотя бы один бит
+    if (original_size > 8 * (uint64_t)(size - STREAM_HEADER_SIZE)) {
+        printf("Ошибка: размер %llu не помещается в %zu байт сжатых данных\n",
+               (unsigned long long)original_size, size - STREAM_HEADER_SIZE);
+        return 0;
+    }
+
+    BitReader r;
+    reader_init(&r, data + STREAM_HEADER_SIZE, size - STREAM_HEADER_SIZE);
+    int lengths[MAX_SYMBOLS];
+    int modes[MAX_SYMBOLS];
+    // Декодеры: [MAX_SYMBOLS] - общий код, остальные - по контекстам со своей таблицей
+    Decoder* decoders = (Decoder*)malloc((MAX_SYMBOLS + 1) * sizeof(Decoder));
+    Decoder* context_decoder[MAX_SYMBOLS];
+    int ok = read_table(&r, lengths) && decoder_init(&decoders[MAX_SYMBOLS], lengths);
+    for (int c = 0; ok && c < MAX_SYMBOLS; c++) modes[c] = (int)reader_get(&r, 2);
+    for (int c = 0; ok && c < MAX_SYMBOLS; c++) {
+        context_decoder[c] = NULL;
+        if (modes[c] == CONTEXT_ORDER0) {
+            context_decoder[c] = &decoders[MAX_SYMBOLS];
+        } else if (modes[c] == CONTEXT_OWN) {
+            ok = read_table(&r, lengths) && decoder_init(&decoders[c], lengths);
+            context_decoder[c] = &decoders[c];
+        } else if (modes[c] != CONTEXT_UNUSED) {
+            ok = 0;
+        }
+    }
+    if (!ok) {
+        printf("Ошибка: поврежден заголовок\n");
+        free(decoders);
+        return 0;
+    }
+
+    unsigned char* buffer = (unsigned char*)malloc(OUTPUT_BUFFER_SIZE);
+    size_t used = 0;
+    int previous = 0;
+    double start = now_seconds();
+    for (uint64_t i = 0; i < original_size; i++) {
+        const Decoder* d = context_decoder[previous];
+        int symbol = (d != NULL) ? decode_symbol(d, &r) : DECODE_INVALID;
+        if (symbol < 0) {
+            printf("Ошибка: %s на символе %llu\n", symbol == DECODE_TRUNCATED
+                   ? "сжатые данные обрываются" : "неверная кодовая последовательность",
+                   (unsigned long long)i);
+            ok = 0;
+            break;
+        }
+        buffer[used++] = (unsigned char)symbol;
+        if (used == OUTPUT_BUFFER_SIZE) {
+            fwrite(buffer, 1, used, out);
+            used = 0;
+        }
+        previous = symbol;
+    }
+    fwrite(buffer, 1, used, out);
+    stats->code_time = now_seconds() - start;
+    free(buffer);
+    free(decoders);
+    return ok && !ferror(out);
+}
+
+// ---------------- Режимы ----------------
+
+// Энтропия нулевого порядка H(X) и условная энтропия H(X | предыдущий байт), бит/символ
+void entropies(const unsigned char* data, size_t size, double* h0, double* h1) {
+    uint64_t (*pairs)[MAX_SYMBOLS] = calloc(MAX_SYMBOLS, sizeof(*pairs));
+    uint64_t counts[MAX_SYMBOLS] = {0};
+    uint64_t contexts[MAX_SYMBOLS] = {0};
+    int previous = 0;
+    for (size_t i = 0; i < size; i++) {
+        pairs[previous][data[i]]++;
+        contexts[previous]++;
+        counts[data[i]]++;
+        previous = data[i];
+    }
+    *h0 = 0;
+    *h1 = 0;
+    for (int s = 0; s < MAX_SYMBOLS; s++) {
+        if (counts[s] > 0) *h0 -= (double)counts[s] / size * log2((double)counts[s] / size);
+    }
+    for (int c = 0; c < MAX_SYMBOLS; c++) {
+        for (int s = 0; s < MAX_SYMBOLS; s++) {
+            if (pairs[c][s] == 0) continue;
+            *h1 -= (double)pairs[c][s] / size * log2((double)pairs[c][s] / contexts[c]);
+        }
+    }
+    free(pairs);
+}
+
+int process_file(const char* input, const char* output, int decode) {
+    MappedFile in;
+    if (!map_file(input, &in)) return 0;
+    FILE* out = fopen(output, "wb");
+    if (!out) {
+        printf("Ошибка: не удалось создать файл %s\n", output);
+        unmap_file(&in);
+        return 0;
+    }
+
+    CodecStats stats;
+    ContextModel* model = (ContextModel*)malloc(sizeof(ContextModel));
+    int ok = decode ? decode_data(in.data, in.size, out, &stats) : encode_data(in.data, in.size, out, &stats, model);
+    ok = (fclose(out) == 0) && ok;
+    unmap_file(&in);
+    if (!ok) {
+        printf("Ошибка обработки %s\n", input);
+        free(model);
+        return 0;
+    }
+
+    if (decode) {
+        printf("Сжатый файл: %zu байт, восстановлено: %zu байт\n", stats.input_size, stats.output_size);
+    } else {
+        printf("Исходный файл: %zu байт, сжатый: %zu байт (%.2f%%)\n", stats.input_size, stats.output_size,
+               stats.input_size ? 100.0 * stats.output_size / stats.input_size : 0.0);
+        printf("Контекстов со своей таблицей: %d, с общим кодом: %d, заголовок: %llu байт\n",
+               model->own_tables, model->shared_contexts,
+               (unsigned long long)(STREAM_HEADER_SIZE + model->header_bits / 8));
+    }
+    free(model);
+    return 1;
+}
+
+int round_trip(int count, char* files[]) {
+    const char* headers[] = {"Файл", "Байт", "H0", "H1", "Порядок 0", "Порядок 1",
+                             "Выигрыш", "Свои/общие", "Проверка"};
+    int widths[] = {26, 9, 6, 6, 10, 10, 8, 10, 10};
+    const char* line = "+----------------------------+-----------+--------+--------+------------+------------"
+                       "+----------+------------+------------+\n";
+    printf("H0 - энтропия нулевого порядка, H1 - условная энтропия по предыдущему байту (бит/символ);\n");
+    printf("порядок 0 и 1 - размер сжатого файла в байтах\n");
+    printf("%s", line);
+    for (int c = 0; c < 9; c++) print_cell(headers[c], widths[c]);
+    printf("|\n%s", line);
+
+    int all_ok = 1;
+    ContextModel* order0 = (ContextModel*)malloc(sizeof(ContextModel));
+    ContextModel* order1 = (ContextModel*)malloc(sizeof(ContextModel));
+    for (int f = 0; f < count; f++) {
+        MappedFile in;
+        if (!map_file(files[f], &in)) {
+            all_ok = 0;
+            continue;
+        }
+        double h0, h1;
+        entropies(in.data, in.size, &h0, &h1);
+        build_model(in.data, in.size, 0, order0);
+
+        char* packed = NULL;
+        size_t packed_size = 0;
+        FILE* packed_stream = open_memstream(&packed, &packed_size);
+        CodecStats stats;
+        int ok = encode_data(in.data, in.size, packed_stream, &stats, order1);
+        fclose(packed_stream);
+        ok = ok && packed_size == model_size(order1);
+
+        char* restored = NULL;
+        size_t restored_size = 0;
+        FILE* restored_stream = open_memstream(&restored, &restored_size);
+        ok = ok && decode_data((const unsigned char*)packed, packed_size, restored_stream, &stats);
+        fclose(restored_stream);
+        ok = ok && restored_size == in.size && (in.size == 0 || memcmp(restored, in.data, in.size) == 0);
+        all_ok = all_ok && ok;
+
+        size_t size0 = model_size(order0);
+        char tables[32];
+        snprintf(tables, sizeof(tables), "%d/%d", order1->own_tables, order1->shared_contexts);
+        print_cell(files[f], widths[0]);
+        printf("| %9zu | %6.3f | %6.3f | %10zu | %10zu | %7.2f%% ", in.size, h0, h1, size0, packed_size,
+               size0 ? 100.0 * ((double)size0 - (double)packed_size) / size0 : 0.0);
+        print_cell(tables, widths[7]);
+        print_cell(ok ? "совпадает" : "ОШИБКА", widths[8]);
+        printf("|\n");
+
+        free(packed);
+        free(restored);
+        unmap_file(&in);
+    }
+    printf("%s", line);
+    free(order0);
+    free(order1);
+    return all_ok;
+}
+
+void print_usage(const char* program) {
+    printf("Использование:\n");
+    printf("  %s -e <исходный файл> <сжатый файл>\n", program);
+    printf("  %s -d <сжатый файл> <восстановленный файл>\n", program);
+    printf("  %s -t <файл>...\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 4 && strcmp(argv[1], "-e") == 0) {
+        return process_file(argv[2], argv[3], 0) ? 0 : 1;
+    }
+    if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+        return process_file(argv[2], argv[3], 1) ? 0 : 1;
+    }
+    if (argc >= 3 && strcmp(argv[1], "-t") == 0) {
+        return round_trip(argc - 2, argv + 2) ? 0 : 1;
+    }
+    print_usage(argv[0]);
+    return 1;
+}
@@ -2,22 +2,101 @@
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
-#define MAX_N 100
+// Сборка: gcc -O2 -pthread 1.c -o task1 -lm
+// Запуск: ./task1 [n] [число потоков] [доля промахов, %]
+
+#define MIN_PARALLEL_N 512
+#define MIN_GRAIN 64
+#define CHUNKS_PER_THREAD 8
 
 typedef struct Node {
     int key;
-    int weight;
+    long long weight;
     struct Node *left;
     struct Node *right;
 } Node;
 
-int AW[MAX_N+1][MAX_N+1];
-int AP[MAX_N+1][MAX_N+1];
-int AR[MAX_N+1][MAX_N+1];
-int weights[MAX_N];
+// Матрицы AP и AR хранятся упакованным верхним треугольником (i <= j) одним блоком,
+// AW[i][j] не хранится, а берется как разность префиксных сумм весов
+long long* AP = NULL;
+int* AR = NULL;
+long long* prefixWeights = NULL;
+long long* weights = NULL;
+// Веса неуспешного поиска: gapWeights[i] - поиск значения между ключами i и i+1
+// (gapWeights[0] - меньше первого ключа, gapWeights[N] - больше последнего)
+long long* gapWeights = NULL;
+long long* prefixGaps = NULL;
+int N = 0;
+
+int threadsCount = 1;
+pthread_barrier_t diagonalBarrier;
+atomic_int* nextCell = NULL;
+
+// Индекс элемента (i, j), 0 <= i <= j <= N, в упакованном треугольнике
+static inline size_t triIndex(int i, int j) {
+    return (size_t)i * (2 * (size_t)N + 3 - i) / 2 + (j - i);
+}
+
+// AW[i][j] = p[i+1] + ... + p[j] + q[i] + ... + q[j]
+static inline long long getAW(int i, int j) {
+    return prefixWeights[j] - prefixWeights[i] + prefixGaps[j + 1] - prefixGaps[i];
+}
+
+static inline long long getAP(int i, int j) {
+    return AP[triIndex(i, j)];
+}
+
+static inline long long getAR(int i, int j) {
+    return AR[triIndex(i, j)];
+}
+
+// Оценка памяти под матрицы для n ключей (в байтах)
+double estimateMemory(int n) {
+    double cells = ((double)n + 1) * ((double)n + 2) / 2;
+    return cells * (sizeof(long long) + sizeof(int)) + ((double)n + 2) * 4 * sizeof(long long);
+}
+
+// Выделение памяти с предварительной проверкой: запрос, который заведомо
+// не поместится в физическую память, отклоняется до начала вычислений
+int allocateMatrices(int n) {
+    double need = estimateMemory(n);
+    double available = (double)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGE_SIZE);
+    printf("Оценка памяти для n=%d: %.1f МБ (физической памяти %.1f МБ)\n",
+           n, need / (1 << 20), available / (1 << 20));
+    if (available > 0 && need > available) {
+        printf("Ошибка: матрицы для n=%d не помещаются в память\n", n);
+        return 0;
+    }
+
+    N = n;
+    size_t cells = ((size_t)n + 1) * ((size_t)n + 2) / 2;
+    AP = (long long*)malloc(cells * sizeof(long long));
+    AR = (int*)malloc(cells * sizeof(int));
+    prefixWeights = (long long*)malloc(((size_t)n + 1) * sizeof(long long));
+    weights = (long long*)malloc(((size_t)n + 1) * sizeof(long long));
+    gapWeights = (long long*)calloc((size_t)n + 1, sizeof(long long));
+    prefixGaps = (long long*)malloc(((size_t)n + 2) * sizeof(long long));
+    if (!AP || !AR || !prefixWeights || !weights || !gapWeights || !prefixGaps) {
+        printf("Ошибка: не удалось выделить %.1f МБ\n", need / (1 << 20));
+        return 0;
+    }
+    return 1;
+}
+
+void freeMatrices() {
+    free(AP);
+    free(AR);
+    free(prefixWeights);
+    free(weights);
+    free(gapWeights);
+    free(prefixGaps);
+}
 
-Node* createNode(int key, int weight) {
+Node* createNode(int key, long long weight) {
     Node* newNode = (Node*)malloc(sizeof(Node));
     newNode->key = key;
     newNode->weight = weight;
@@ -27,56 +106,103 @@ Node* createNode(int key, int weight) {
 }
 
 void computeAW(int n) {
-    int i, j;
-    for (i = 0; i <= n; i++) {
-        AW[i][i] = 0;
-        for (j = i+1; j <= n; j++) {
-            AW[i][j] = AW[i][j-1] + weights[j-1];
+    prefixWeights[0] = 0;
+    for (int i = 1; i <= n; i++) {
+        prefixWeights[i] = prefixWeights[i-1] + weights[i-1];
+    }
+    prefixGaps[0] = 0;
+    for (int i = 1; i <= n + 1; i++) {
+        prefixGaps[i] = prefixGaps[i-1] + gapWeights[i-1];
+    }
+}
+
+// Вычисление одной клетки (i, j): зависит только от интервалов меньшей длины
+static inline void computeCell(int i, int j) {
+    // Строка i упакованного треугольника непрерывна: AP[i][k-1] идут подряд
+    long long* rowI = AP + triIndex(i, i) - i;
+
+    int m = AR[triIndex(i, j-1)];
+    long long min_val = rowI[m-1] + AP[triIndex(m, j)];
+    
+    int max_k = AR[triIndex(i+1, j)];
+    for (int k = m+1; k <= max_k; k++) {
+        long long x = rowI[k-1] + AP[triIndex(k, j)];
+        if (x < min_val) {
+            m = k;
+            min_val = x;
         }
     }
+    
+    AP[triIndex(i, j)] = min_val + getAW(i, j);
+    AR[triIndex(i, j)] = m;
+}
+
+// Все клетки одной диагонали h независимы. Потоки разбирают диагональ порциями
+// через атомарный счетчик и ждут друг друга на барьере перед следующей диагональю
+void* diagonalWorker(void* arg) {
+    (void)arg;
+    int n = N;
+    for (int h = 2; h <= n; h++) {
+        int cells = n - h + 1;
+        // На коротких h клетки дешевые, поэтому порция не меньше MIN_GRAIN
+        int grain = cells / (threadsCount * CHUNKS_PER_THREAD);
+        if (grain < MIN_GRAIN) grain = MIN_GRAIN;
+        
+        for (;;) {
+            int first = atomic_fetch_add_explicit(&nextCell[h], grain, memory_order_relaxed);
+            if (first >= cells) break;
+            int last = (first + grain < cells) ? first + grain : cells;
+            for (int i = first; i < last; i++) {
+                computeCell(i, i + h);
+            }
+        }
+        pthread_barrier_wait(&diagonalBarrier);
+    }
+    return NULL;
 }
 
 void computeAPAR(int n) {
-    int i, j, k, h;
+    int i, j, h;
     
+    // Пустой интервал - одна лакуна, поиск в ней уже закончился: AP[i][i] = 0
     for (i = 0; i <= n; i++) {
-        for (j = 0; j <= n; j++) {
-            AP[i][j] = 0;
-            AR[i][j] = 0;
-        }
+        AP[triIndex(i, i)] = 0;
+        AR[triIndex(i, i)] = 0;
     }
     
     for (i = 0; i < n; i++) {
         j = i + 1;
-        AP[i][j] = AW[i][j];
-        AR[i][j] = j;
-    }
-    
-    for (h = 2; h <= n; h++) {
-        for (i = 0; i <= n - h; i++) {
-            j = i + h;
-
-            int m = AR[i][j-1];     
-            int min_val = AP[i][m-1] + AP[m][j];
-            
-            int max_k = (AR[i+1][j] > 0) ? AR[i+1][j] : j;
-            for (k = m+1; k <= max_k; k++) {
-                int x = AP[i][k-1] + AP[k][j];
-                if (x < min_val) {
-                    m = k;
-                    min_val = x;
-                }
+        AP[triIndex(i, j)] = getAW(i, j);
+        AR[triIndex(i, j)] = j;
+    }
+    
+    if (threadsCount <= 1 || n < MIN_PARALLEL_N) {
+        for (h = 2; h <= n; h++) {
+            for (i = 0; i <= n - h; i++) {
+                computeCell(i, i + h);
             }
-            
-            AP[i][j] = min_val + AW[i][j];
-            AR[i][j] = m;
         }
+        return;
+    }
+    
+    nextCell = (atomic_int*)calloc(n + 1, sizeof(atomic_int));
+    pthread_barrier_init(&diagonalBarrier, NULL, threadsCount);
+    pthread_t* threads = (pthread_t*)malloc(threadsCount * sizeof(pthread_t));
+    for (int t = 1; t < threadsCount; t++) {
+        pthread_create(&threads[t], NULL, diagonalWorker, NULL);
     }
+    diagonalWorker(NULL);
+    for (int t = 1; t < threadsCount; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_barrier_destroy(&diagonalBarrier);
+    free(threads);
+    free((void*)nextCell);
 }
 
 Node* createTree(int L, int R) {
     if (L < R) {
-        int k = AR[L][R];
+        int k = AR[triIndex(L, R)];
         Node* root = createNode(k, weights[k-1]);
         root->left = createTree(L, k-1);
         root->right = createTree(k, R);
@@ -88,7 +214,7 @@ Node* createTree(int L, int R) {
 void inOrderTraversal(Node* root) {
     if (root != NULL) {
         inOrderTraversal(root->left);
-        printf("%d(w:%d) ", root->key, root->weight);
+        printf("%d(w:%lld) ", root->key, root->weight);
         inOrderTraversal(root->right);
     }
 }
@@ -98,12 +224,12 @@ int treeSize(Node* root) {
     return 1 + treeSize(root->left) + treeSize(root->right);
 }
 
-int checkSum(Node* root) {
+long long checkSum(Node* root) {
     if (root == NULL) return 0;
     return root->key + checkSum(root->left) + checkSum(root->right);
 }
 
-    int treeHeight(Node* root) {
+int treeHeight(Node* root) {
     if (root == NULL) return 0;
     int leftHeight = treeHeight(root->left);
     int rightHeight = treeHeight(root->right);
@@ -112,24 +238,43 @@ int checkSum(Node* root) {
 
 double weightedHeight(Node* root, int level) {
     if (root == NULL) return 0;
-    return root->weight * level + 
+    return (double)root->weight * level + 
            weightedHeight(root->left, level + 1) + 
            weightedHeight(root->right, level + 1);
 }
 
-void printMatrixPartial(int matrix[MAX_N+1][MAX_N+1], int n, char* name) {
-    printf("\nМатрица %s (первые 10x10 элементов):\n", name);
+// Число сравнений неуспешного поиска равно уровню вершины, у которой нет нужного
+// потомка. Пустые ссылки встречаются при обходе слева направо в порядке лакун
+double missWeightedHeight(Node* root, int level, int* gapIndex) {
+    if (root == NULL) {
+        return (double)gapWeights[(*gapIndex)++] * (level - 1);
+    }
+    double left = missWeightedHeight(root->left, level + 1, gapIndex);
+    return left + missWeightedHeight(root->right, level + 1, gapIndex);
+}
+
+void freeTree(Node* root) {
+    if (root != NULL) {
+        freeTree(root->left);
+        freeTree(root->right);
+        free(root);
+    }
+}
+
+void printMatrixPartial(long long (*matrix)(int, int), int n, char* name) {
+    int limit = (n < 10) ? n : 10;
+    printf("\nМатрица %s (первые %dx%d элементов):\n", name, limit + 1, limit + 1);
     printf("i\\j");
-    for (int j = 0; j <= 10; j++) {
+    for (int j = 0; j <= limit; j++) {
         printf("%8d", j);
     }
     printf("\n");
     
-    for (int i = 0; i <= 10; i++) {
+    for (int i = 0; i <= limit; i++) {
         printf("%2d ", i);
-        for (int j = 0; j <= 10; j++) {
+        for (int j = 0; j <= limit; j++) {
             if (j >= i) {
-                printf("%8d", matrix[i][j]);
+                printf("%8lld", matrix(i, j));
             } else {
                 printf("        ");
             }
@@ -138,48 +283,95 @@ void printMatrixPartial(int matrix[MAX_N+1][MAX_N+1], int n, char* name) {
     }
 }
 
-int main() {
-    int n = 10;
+int main(int argc, char* argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 10;
+    threadsCount = (argc > 2) ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int missPercent = (argc > 3) ? atoi(argv[3]) : 0;
+    if (n < 1 || threadsCount < 1 || missPercent < 0 || missPercent > 99) {
+        printf("Использование: %s [n] [число потоков] [доля промахов, %%]\n", argv[0]);
+        return 1;
+    }
     srand(time(NULL));
     
+    if (!allocateMatrices(n)) {
+        freeMatrices();
+        return 1;
+    }
+    
     for (int i = 0; i < n; i++) {
         weights[i] = rand() % 100 + 1;
     }
+    // Веса лакун того же порядка, масштабированные так, чтобы промахи
+    // составляли примерно missPercent процентов всех поисков
+    if (missPercent > 0) {
+        for (int i = 0; i <= n; i++) {
+            gapWeights[i] = (long long)(rand() % 100 + 1) * missPercent / (100 - missPercent);
+        }
+    }
     
-    printf("Ключи и веса вершин:\n");
-    for (int i = 0; i < n; i++) {
-        printf("Ключ: %d, Вес: %d\n", i+1, weights[i]);
+    if (n <= 100) {
+        printf("Ключи и веса вершин:\n");
+        for (int i = 0; i < n; i++) {
+            printf("Ключ: %d, Вес: %lld\n", i+1, weights[i]);
+        }
+        if (missPercent > 0) {
+            printf("Веса лакун q0..q%d:", n);
+            for (int i = 0; i <= n; i++) {
+                printf(" %lld", gapWeights[i]);
+            }
+            printf("\n");
+        }
+        printf("\n");
     }
-    printf("\n");
 
-    printf("\nВычисление матриц...\n");
+    printf("\nВычисление матриц (потоков: %d)...\n", threadsCount);
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
     computeAW(n);
     computeAPAR(n);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Время вычисления матриц: %.3f с\n",
+           (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
     
-    printMatrixPartial(AW, n, "AW");
-    printMatrixPartial(AP, n, "AP"); 
-    printMatrixPartial(AR, n, "AR");
+    printMatrixPartial(getAW, n, "AW");
+    printMatrixPartial(getAP, n, "AP"); 
+    printMatrixPartial(getAR, n, "AR");
     
     printf("\nПостроение дерева...\n");
     Node* root = createTree(0, n);
     
     int size = treeSize(root);
-    int sum = checkSum(root);
+    long long sum = checkSum(root);
     int height = treeHeight(root);
     double wHeight = weightedHeight(root, 1);
-    double avgWeightedHeight = wHeight / AW[0][n];
+    int gapIndex = 0;
+    double missHeight = missWeightedHeight(root, 1, &gapIndex);
+    long long hitWeight = prefixWeights[n];
+    long long missWeight = prefixGaps[n + 1];
+    double avgWeightedHeight = (wHeight + missHeight) / getAW(0, n);
     
     
     printf("\n");
     printf("n=%d   Размер   Контр. Сумма    Высота  Средневзвеш.высота\n", n);
-    printf("ДОП   %6d   %11d   %6d   %17.2f\n", 
+    printf("ДОП   %6d   %11lld   %6d   %17.2f\n", 
            size, sum, height, avgWeightedHeight);
     
-    double matrixRatio = (double)AP[0][n] / AW[0][n];
+    double matrixRatio = (double)getAP(0, n) / getAW(0, n);
     printf("\nПроверка правильности алгоритма:\n");
     printf("AP[0,n]/AW[0,n] = %.6f\n", matrixRatio);
     printf("Средневзвешенная высота = %.6f\n", avgWeightedHeight);
     printf("Разница: %.6f\n", fabs(matrixRatio - avgWeightedHeight));
     
+    if (missWeight > 0) {
+        printf("\nОжидаемое число сравнений:\n");
+        printf("Успешный поиск (доля %.1f%%): %.6f\n",
+               100.0 * hitWeight / getAW(0, n), wHeight / hitWeight);
+        printf("Неуспешный поиск (доля %.1f%%): %.6f\n",
+               100.0 * missWeight / getAW(0, n), missHeight / missWeight);
+        printf("Все поиски: %.6f\n", avgWeightedHeight);
+    }
+    
+    freeTree(root);
+    freeMatrices();
     return 0;
 }
\ No newline at end of file
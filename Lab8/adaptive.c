@@ -0,0 +1,391 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+// Самонастраивающееся ДОП: считает обращения к ключам на "живом" дереве и,
+// когда средневзвешенная высота уходит от оптимума для текущих счетчиков,
+// перестраивает дерево в фоновом потоке и атомарно подменяет корень.
+// Сборка: gcc -O2 -pthread adaptive.c -o adaptive -lm
+// Запуск: ./adaptive [n] [поисков на поток] [потоков] [порог] [dop|a2]
+
+#define MAX_READERS 64
+
+typedef struct Node {
+    int key;
+    long long weight;
+    struct Node *left;
+    struct Node *right;
+} Node;
+
+// Версия дерева: корень и номер поколения, подменяются одним указателем
+typedef struct TreeVersion {
+    Node* root;
+    long long generation;
+    double cost;
+} TreeVersion;
+
+typedef struct {
+    int n;
+    double threshold;
+    int useA2;
+    int checkIntervalMs;
+} AdaptiveConfig;
+
+_Atomic(TreeVersion*) currentTree;
+_Atomic long long* counts;
+_Atomic long long readerSeen[MAX_READERS];
+atomic_int readersCount;
+atomic_int stopBuilder;
+
+int rebuildCount = 0;
+
+Node* createNode(int key, long long weight) {
+    Node* newNode = (Node*)malloc(sizeof(Node));
+    newNode->key = key;
+    newNode->weight = weight;
+    newNode->left = NULL;
+    newNode->right = NULL;
+    return newNode;
+}
+
+void freeTree(Node* root) {
+    if (root != NULL) {
+        freeTree(root->left);
+        freeTree(root->right);
+        free(root);
+    }
+}
+
+// Средневзвешенная высота по заданным весам (а не по весам, с которыми строилось дерево)
+double weightedHeight(Node* root, int level, long long* weights) {
+    if (root == NULL) return 0;
+    return (double)weights[root->key - 1] * level +
+           weightedHeight(root->left, level + 1, weights) +
+           weightedHeight(root->right, level + 1, weights);
+}
+
+// ---------------- Построители ----------------
+
+Node* createTree(int* AR, size_t dim, long long* weights, int L, int R) {
+    if (L < R) {
+        int k = AR[L * dim + R];
+        Node* root = createNode(k, weights[k - 1]);
+        root->left = createTree(AR, dim, weights, L, k - 1);
+        root->right = createTree(AR, dim, weights, k, R);
+        return root;
+    }
+    return NULL;
+}
+
+// Оптимальное дерево (алгоритм Кнута), в *cost возвращается AP[0][n]
+Node* buildOptimal(long long* weights, int n, double* cost) {
+    size_t dim = (size_t)n + 1;
+    long long* AW = (long long*)calloc(dim * dim, sizeof(long long));
+    long long* AP = (long long*)calloc(dim * dim, sizeof(long long));
+    int* AR = (int*)calloc(dim * dim, sizeof(int));
+    if (!AW || !AP || !AR) {
+        free(AW);
+        free(AP);
+        free(AR);
+        return NULL;
+    }
+
+    for (int i = 0; i <= n; i++) {
+        for (int j = i + 1; j <= n; j++) {
+            AW[i * dim + j] = AW[i * dim + j - 1] + weights[j - 1];
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        AP[i * dim + i + 1] = AW[i * dim + i + 1];
+        AR[i * dim + i + 1] = i + 1;
+    }
+    for (int h = 2; h <= n; h++) {
+        for (int i = 0; i <= n - h; i++) {
+            int j = i + h;
+            int m = AR[i * dim + j - 1];
+            long long minVal = AP[i * dim + m - 1] + AP[m * dim + j];
+            int maxK = AR[(i + 1) * dim + j];
+            for (int k = m + 1; k <= maxK; k++) {
+                long long x = AP[i * dim + k - 1] + AP[k * dim + j];
+                if (x < minVal) {
+                    m = k;
+                    minVal = x;
+                }
+            }
+            AP[i * dim + j] = minVal + AW[i * dim + j];
+            AR[i * dim + j] = m;
+        }
+    }
+
+    *cost = (double)AP[n];
+    Node* root = createTree(AR, dim, weights, 0, n);
+    free(AW);
+    free(AP);
+    free(AR);
+    return root;
+}
+
+// A2: корень - первый ключ, на котором префиксная сумма переходит половину веса
+Node* buildA2Range(long long* prefix, long long* weights, int left, int right) {
+    if (left > right) return NULL;
+    if (left == right) return createNode(left + 1, weights[left]);
+
+    long long half = (prefix[right + 1] - prefix[left]) / 2;
+    int lo = left, hi = right;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (prefix[mid + 1] - prefix[left] > half) hi = mid;
+        else lo = mid + 1;
+    }
+    int rootIndex = lo;
+
+    Node* root = createNode(rootIndex + 1, weights[rootIndex]);
+    root->left = buildA2Range(prefix, weights, left, rootIndex - 1);
+    root->right = buildA2Range(prefix, weights, rootIndex + 1, right);
+    return root;
+}
+
+Node* buildA2(long long* weights, int n, double* cost) {
+    long long* prefix = (long long*)malloc(((size_t)n + 1) * sizeof(long long));
+    prefix[0] = 0;
+    for (int i = 0; i < n; i++) prefix[i + 1] = prefix[i] + weights[i];
+    Node* root = buildA2Range(prefix, weights, 0, n - 1);
+    free(prefix);
+    *cost = weightedHeight(root, 1, weights);
+    return root;
+}
+
+// ---------------- Поиск на живом дереве ----------------
+
+// Поиск читает текущую версию дерева и отмечает, какое поколение он видел:
+// старое дерево освобождается только когда все читатели ушли с него
+int adaptiveLookup(int readerId, int key) {
+    TreeVersion* v = atomic_load_explicit(&currentTree, memory_order_acquire);
+    Node* p = v->root;
+    while (p != NULL && p->key != key) {
+        p = (key < p->key) ? p->left : p->right;
+    }
+    if (p != NULL) {
+        atomic_fetch_add_explicit(&counts[key - 1], 1, memory_order_relaxed);
+    }
+    atomic_store_explicit(&readerSeen[readerId], v->generation, memory_order_release);
+    return p != NULL;
+}
+
+void waitForReaders(long long generation) {
+    int readers = atomic_load(&readersCount);
+    for (int r = 0; r < readers; r++) {
+        while (atomic_load_explicit(&readerSeen[r], memory_order_acquire) < generation) {
+            sched_yield();
+        }
+    }
+}
+
+// ---------------- Фоновый перестроитель ----------------
+
+void* builderThread(void* arg) {
+    AdaptiveConfig* config = (AdaptiveConfig*)arg;
+    int n = config->n;
+    long long* snapshot = (long long*)malloc(n * sizeof(long long));
+
+    while (!atomic_load(&stopBuilder)) {
+        usleep(config->checkIntervalMs * 1000);
+
+        // Снимок счетчиков; +1, чтобы ключи без обращений не выпадали из оценки
+        for (int i = 0; i < n; i++) {
+            snapshot[i] = atomic_load_explicit(&counts[i], memory_order_relaxed) + 1;
+        }
+
+        TreeVersion* old = atomic_load_explicit(&currentTree, memory_order_acquire);
+        double currentCost = weightedHeight(old->root, 1, snapshot);
+
+        double bestCost = 0;
+        Node* candidate = config->useA2 ? buildA2(snapshot, n, &bestCost)
+                                        : buildOptimal(snapshot, n, &bestCost);
+        if (candidate == NULL) {
+            printf("Ошибка: недостаточно памяти для перестроения (n=%d)\n", n);
+            break;
+        }
+
+        if (currentCost <= bestCost * (1.0 + config->threshold)) {
+            freeTree(candidate);
+            continue;
+        }
+
+        TreeVersion* fresh = (TreeVersion*)malloc(sizeof(TreeVersion));
+        fresh->root = candidate;
+        fresh->generation = old->generation + 1;
+        fresh->cost = bestCost;
+        atomic_store_explicit(&currentTree, fresh, memory_order_release);
+        rebuildCount++;
+
+        long long totalWeight = 0;
+        for (int i = 0; i < n; i++) totalWeight += snapshot[i];
+        printf("  перестроение #%d: средневзв. высота %.4f -> %.4f\n",
+               rebuildCount, currentCost / totalWeight, bestCost / totalWeight);
+
+        // Старение счетчиков: половина истории забывается, чтобы следить за дрейфом
+        for (int i = 0; i < n; i++) {
+            atomic_fetch_sub_explicit(&counts[i],
+                atomic_load_explicit(&counts[i], memory_order_relaxed) / 2, memory_order_relaxed);
+        }
+
+        waitForReaders(fresh->generation);
+        freeTree(old->root);
+        free(old);
+    }
+
+    free(snapshot);
+    return NULL;
+}
+
+// ---------------- Демонстрация ----------------
+
+typedef struct {
+    int id;
+    int n;
+    int lookups;
+    unsigned long long seed;
+    double* cdfBefore;
+    double* cdfAfter;
+    long long found;
+} ReaderArgs;
+
+unsigned long long nextRandom(unsigned long long* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+int sampleKey(double* cdf, int n, unsigned long long* state) {
+    double u = (nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (cdf[mid] < u) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo + 1;
+}
+
+void* readerThread(void* arg) {
+    ReaderArgs* a = (ReaderArgs*)arg;
+    for (int i = 0; i < a->lookups; i++) {
+        double* cdf = (i < a->lookups / 2) ? a->cdfBefore : a->cdfAfter;
+        a->found += adaptiveLookup(a->id, sampleKey(cdf, a->n, &a->seed));
+    }
+    // Завершившийся читатель больше не держит ни одно поколение
+    atomic_store(&readerSeen[a->id], (long long)1 << 62);
+    return NULL;
+}
+
+// Zipf-распределение со случайной раздачей рангов ключам
+void buildZipfCdf(int n, double s, double* cdf, unsigned long long* state) {
+    int* perm = (int*)malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) perm[i] = i;
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)(nextRandom(state) % (unsigned long long)(i + 1));
+        int t = perm[i]; perm[i] = perm[j]; perm[j] = t;
+    }
+    double total = 0;
+    for (int i = 0; i < n; i++) total += 1.0 / pow(perm[i] + 1, s);
+    double sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum += 1.0 / pow(perm[i] + 1, s) / total;
+        cdf[i] = sum;
+    }
+    cdf[n - 1] = 1.0;
+    free(perm);
+}
+
+int main(int argc, char* argv[]) {
+    AdaptiveConfig config;
+    config.n = (argc > 1) ? atoi(argv[1]) : 1000;
+    int lookups = (argc > 2) ? atoi(argv[2]) : 2000000;
+    int readers = (argc > 3) ? atoi(argv[3]) : 2;
+    config.threshold = (argc > 4) ? atof(argv[4]) : 0.05;
+    config.useA2 = (argc > 5 && strcmp(argv[5], "a2") == 0);
+    config.checkIntervalMs = 50;
+    int n = config.n;
+
+    if (n < 1 || lookups < 1 || readers < 1 || readers > MAX_READERS) {
+        printf("Использование: %s [n] [поисков на поток] [потоков 1..%d] [порог] [dop|a2]\n",
+               argv[0], MAX_READERS);
+        return 1;
+    }
+
+    unsigned long long seed = 88172645463325252ULL ^ (unsigned long long)time(NULL);
+    double* cdfBefore = (double*)malloc(n * sizeof(double));
+    double* cdfAfter = (double*)malloc(n * sizeof(double));
+    buildZipfCdf(n, 1.0, cdfBefore, &seed);
+    buildZipfCdf(n, 1.0, cdfAfter, &seed);
+
+    counts = (_Atomic long long*)calloc(n, sizeof(_Atomic long long));
+
+    // Начальное дерево - по равным весам, пока статистики нет
+    long long* uniform = (long long*)malloc(n * sizeof(long long));
+    for (int i = 0; i < n; i++) uniform[i] = 1;
+    TreeVersion* initial = (TreeVersion*)malloc(sizeof(TreeVersion));
+    initial->root = config.useA2 ? buildA2(uniform, n, &initial->cost)
+                                 : buildOptimal(uniform, n, &initial->cost);
+    initial->generation = 0;
+    free(uniform);
+    if (initial->root == NULL) {
+        printf("Ошибка: недостаточно памяти для матриц ДОП (n=%d)\n", n);
+        return 1;
+    }
+    atomic_store(&currentTree, initial);
+
+    printf("Ключей: %d, потоков поиска: %d, поисков на поток: %d\n", n, readers, lookups);
+    printf("Построитель: %s, порог перестроения: %.1f%%\n",
+           config.useA2 ? "A2" : "ДОП", config.threshold * 100);
+
+    atomic_store(&readersCount, readers);
+    pthread_t builder;
+    pthread_create(&builder, NULL, builderThread, &config);
+
+    pthread_t* threads = (pthread_t*)malloc(readers * sizeof(pthread_t));
+    ReaderArgs* args = (ReaderArgs*)calloc(readers, sizeof(ReaderArgs));
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < readers; r++) {
+        args[r].id = r;
+        args[r].n = n;
+        args[r].lookups = lookups;
+        args[r].seed = seed + 0x9E3779B97F4A7C15ULL * (r + 1);
+        args[r].cdfBefore = cdfBefore;
+        args[r].cdfAfter = cdfAfter;
+        pthread_create(&threads[r], NULL, readerThread, &args[r]);
+    }
+
+    long long found = 0;
+    for (int r = 0; r < readers; r++) {
+        pthread_join(threads[r], NULL);
+        found += args[r].found;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    atomic_store(&stopBuilder, 1);
+    pthread_join(builder, NULL);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("\nНайдено ключей: %lld из %lld\n", found, (long long)lookups * readers);
+    printf("Перестроений: %d\n", rebuildCount);
+    printf("Время поиска: %.3f с (%.1f нс/поиск)\n", seconds, seconds * 1e9 / ((double)lookups * readers));
+
+    TreeVersion* last = atomic_load(&currentTree);
+    freeTree(last->root);
+    free(last);
+    free(threads);
+    free(args);
+    free((void*)counts);
+    free(cdfBefore);
+    free(cdfAfter);
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Микробенчмарк внутреннего цикла computeAPAR: исходный скалярный цикл против ядра,
+// в котором столбцы AP продублированы транспонированной копией, клетки обходятся
+// по строкам снизу вверх, а минимум по окну Кнута [AR[i][j-1], AR[i+1][j]]
+// ищется векторно (AVX2).
+// Сборка: gcc -O2 -mavx2 dp_bench.c -o dp_bench
+// Запуск: ./dp_bench [n] [повторов]
+
+// Окна короче этого значения обрабатываются скалярно: у большинства клеток окно
+// из 1-3 кандидатов, и векторная обвязка дороже самого поиска
+#define SIMD_MIN_WINDOW 8
+
+long long* weights;
+long long* prefixWeights;
+int N;
+
+static inline size_t triIndex(int i, int j) {
+    return (size_t)i * (2 * (size_t)N + 3 - i) / 2 + (j - i);
+}
+
+// Столбец j транспонированной копии: элементы (0, j), (1, j), ..., (j, j) подряд
+static inline size_t colIndex(int k, int j) {
+    return (size_t)j * (j + 1) / 2 + k;
+}
+
+// ---------------- Скалярное ядро (как в Lab8) ----------------
+
+void computeScalar(long long* AP, int* AR, int n) {
+    for (int i = 0; i <= n; i++) {
+        AP[triIndex(i, i)] = 0;
+        AR[triIndex(i, i)] = 0;
+    }
+    for (int i = 0; i < n; i++) {
+        AP[triIndex(i, i + 1)] = prefixWeights[i + 1] - prefixWeights[i];
+        AR[triIndex(i, i + 1)] = i + 1;
+    }
+    for (int h = 2; h <= n; h++) {
+        for (int i = 0; i <= n - h; i++) {
+            int j = i + h;
+            long long* rowI = AP + triIndex(i, i) - i;
+            int m = AR[triIndex(i, j - 1)];
+            long long minVal = rowI[m - 1] + AP[triIndex(m, j)];
+            int maxK = AR[triIndex(i + 1, j)];
+            for (int k = m + 1; k <= maxK; k++) {
+                long long x = rowI[k - 1] + AP[triIndex(k, j)];
+                if (x < minVal) {
+                    m = k;
+                    minVal = x;
+                }
+            }
+            AP[triIndex(i, j)] = minVal + prefixWeights[j] - prefixWeights[i];
+            AR[triIndex(i, j)] = m;
+        }
+    }
+}
+
+// ---------------- Ядро с транспонированной копией ----------------
+
+// Минимум rowI[k-1] + colJ[k] по k = from..to; при равенстве берется наименьший k,
+// как в скалярном цикле
+static inline int windowArgmin(const long long* rowI, const long long* colJ, int from, int to,
+                               long long* minOut) {
+    int m = from;
+    long long minVal = rowI[from - 1] + colJ[from];
+
+#if defined(__AVX2__)
+    if (to - from + 1 >= SIMD_MIN_WINDOW) {
+        __m256i best = _mm256_set1_epi64x(minVal);
+        int k = from + 1;
+        for (; k + 3 <= to; k += 4) {
+            __m256i a = _mm256_loadu_si256((const __m256i*)(rowI + k - 1));
+            __m256i b = _mm256_loadu_si256((const __m256i*)(colJ + k));
+            __m256i x = _mm256_add_epi64(a, b);
+            __m256i less = _mm256_cmpgt_epi64(best, x);
+            best = _mm256_blendv_epi8(best, x, less);
+        }
+        long long lanes[4];
+        _mm256_storeu_si256((__m256i*)lanes, best);
+        long long vecMin = lanes[0];
+        for (int l = 1; l < 4; l++) {
+            if (lanes[l] < vecMin) vecMin = lanes[l];
+        }
+        for (; k <= to; k++) {
+            long long x = rowI[k - 1] + colJ[k];
+            if (x < vecMin) vecMin = x;
+        }
+        // Второй проход по уже прогретым строкам: первый k с минимальным значением
+        if (vecMin < minVal) {
+            for (k = from + 1; rowI[k - 1] + colJ[k] != vecMin; k++) {
+            }
+            m = k;
+            minVal = vecMin;
+        }
+        *minOut = minVal;
+        return m;
+    }
+#endif
+
+    for (int k = from + 1; k <= to; k++) {
+        long long x = rowI[k - 1] + colJ[k];
+        if (x < minVal) {
+            m = k;
+            minVal = x;
+        }
+    }
+    *minOut = minVal;
+    return m;
+}
+
+// Клетка (i, j) зависит от (i, j-1) и от строк ниже i, поэтому строки можно считать
+// от n-2 к 0: строка i пишется подряд, а строка i+1 (AR[i+1][j]) еще в кэше
+void computeTransposed(long long* AP, long long* APT, int* AR, int n) {
+    for (int i = 0; i <= n; i++) {
+        AP[triIndex(i, i)] = 0;
+        APT[colIndex(i, i)] = 0;
+        AR[triIndex(i, i)] = 0;
+    }
+    for (int i = 0; i < n; i++) {
+        long long w = prefixWeights[i + 1] - prefixWeights[i];
+        AP[triIndex(i, i + 1)] = w;
+        APT[colIndex(i, i + 1)] = w;
+        AR[triIndex(i, i + 1)] = i + 1;
+    }
+    for (int i = n - 2; i >= 0; i--) {
+        for (int j = i + 2; j <= n; j++) {
+            // Оба операнда читаются последовательно: строка i из AP, столбец j из APT
+            const long long* rowI = AP + triIndex(i, i) - i;
+            const long long* colJ = APT + colIndex(0, j);
+            long long minVal;
+            int m = windowArgmin(rowI, colJ, AR[triIndex(i, j - 1)], AR[triIndex(i + 1, j)], &minVal);
+            long long value = minVal + prefixWeights[j] - prefixWeights[i];
+            AP[triIndex(i, j)] = value;
+            APT[colIndex(i, j)] = value;
+            AR[triIndex(i, j)] = m;
+        }
+    }
+}
+
+double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 5000;
+    int repeats = (argc > 2) ? atoi(argv[2]) : 3;
+    if (n < 1 || repeats < 1) {
+        printf("Использование: %s [n] [повторов]\n", argv[0]);
+        return 1;
+    }
+    N = n;
+    srand(time(NULL));
+
+    size_t cells = ((size_t)n + 1) * ((size_t)n + 2) / 2;
+    printf("n=%d, память: %.1f МБ\n", n, cells * (3.0 * sizeof(long long) + 2 * sizeof(int)) / (1 << 20));
+
+    weights = (long long*)malloc(n * sizeof(long long));
+    prefixWeights = (long long*)malloc(((size_t)n + 1) * sizeof(long long));
+    long long* AP1 = (long long*)malloc(cells * sizeof(long long));
+    int* AR1 = (int*)malloc(cells * sizeof(int));
+    long long* AP2 = (long long*)malloc(cells * sizeof(long long));
+    long long* APT = (long long*)malloc(cells * sizeof(long long));
+    int* AR2 = (int*)malloc(cells * sizeof(int));
+    if (!weights || !prefixWeights || !AP1 || !AR1 || !AP2 || !APT || !AR2) {
+        printf("Ошибка: недостаточно памяти\n");
+        return 1;
+    }
+
+    prefixWeights[0] = 0;
+    for (int i = 0; i < n; i++) {
+        weights[i] = rand() % 100 + 1;
+        prefixWeights[i + 1] = prefixWeights[i] + weights[i];
+    }
+
+#if defined(__AVX2__)
+    printf("Векторное ядро: AVX2\n");
+#else
+    printf("Векторное ядро: недоступно (собрано без -mavx2), только транспонирование\n");
+#endif
+
+    double bestScalar = 1e30, bestTransposed = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        double start = nowSeconds();
+        computeScalar(AP1, AR1, n);
+        double t = nowSeconds() - start;
+        if (t < bestScalar) bestScalar = t;
+
+        start = nowSeconds();
+        computeTransposed(AP2, APT, AR2, n);
+        t = nowSeconds() - start;
+        if (t < bestTransposed) bestTransposed = t;
+    }
+
+    int same = memcmp(AP1, AP2, cells * sizeof(long long)) == 0 &&
+               memcmp(AR1, AR2, cells * sizeof(int)) == 0;
+
+    printf("\n+---------------------------+--------------+\n");
+    printf("| %-25s | %12s |\n", "Ядро", "Время, с");
+    printf("+---------------------------+--------------+\n");
+    printf("| %-25s | %12.4f |\n", "Скалярное (Lab8)", bestScalar);
+    printf("| %-25s | %12.4f |\n", "Транспонир. + SIMD", bestTransposed);
+    printf("+---------------------------+--------------+\n");
+    printf("Ускорение: %.2fx\n", bestScalar / bestTransposed);
+    printf("AP[0,n]/AW[0,n] = %.6f, матрицы %s\n",
+           (double)AP1[triIndex(0, n)] / prefixWeights[n], same ? "совпадают" : "РАЗЛИЧАЮТСЯ");
+
+    free(weights);
+    free(prefixWeights);
+    free(AP1);
+    free(AR1);
+    free(AP2);
+    free(APT);
+    free(AR2);
+    return same ? 0 : 1;
+}
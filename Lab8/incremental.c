@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Инкрементальная починка ДОП при изменении весов нескольких ключей.
+// AW[i][j], AP[i][j] и AR[i][j] зависят только от весов ключей i+1..j, поэтому после
+// изменения пакета весов пересчитываются только клетки, интервал которых содержит
+// хотя бы один измененный ключ, а в дереве перестраиваются только поддеревья,
+// у которых сменился корень AR.
+// Сборка: gcc -O2 incremental.c -o incremental
+// Запуск: ./incremental [n] [раундов]
+
+typedef struct Node {
+    int key;
+    long long weight;
+    struct Node *left;
+    struct Node *right;
+} Node;
+
+typedef struct WeightUpdate {
+    int key;
+    long long weight;
+} WeightUpdate;
+
+typedef struct UpdateStats {
+    long long cellsRecomputed;
+    long long rootsChanged;
+    int nodesRebuilt;
+} UpdateStats;
+
+long long* AP = NULL;
+int* AR = NULL;
+long long* prefixWeights = NULL;
+long long* weights = NULL;
+// nextChanged[i] - наименьший измененный ключ больше i (N + 1, если такого нет):
+// интервал (i, j] содержит измененный ключ тогда и только тогда, когда nextChanged[i] <= j
+int* nextChanged = NULL;
+int N = 0;
+
+static inline size_t triIndex(int i, int j) {
+    return (size_t)i * (2 * (size_t)N + 3 - i) / 2 + (j - i);
+}
+
+static inline long long getAW(int i, int j) {
+    return prefixWeights[j] - prefixWeights[i];
+}
+
+Node* createNode(int key, long long weight) {
+    Node* newNode = (Node*)malloc(sizeof(Node));
+    newNode->key = key;
+    newNode->weight = weight;
+    newNode->left = NULL;
+    newNode->right = NULL;
+    return newNode;
+}
+
+void computeAW(int n) {
+    prefixWeights[0] = 0;
+    for (int i = 1; i <= n; i++) {
+        prefixWeights[i] = prefixWeights[i-1] + weights[i-1];
+    }
+}
+
+static inline void computeCell(int i, int j) {
+    long long* rowI = AP + triIndex(i, i) - i;
+    int m = AR[triIndex(i, j-1)];
+    long long min_val = rowI[m-1] + AP[triIndex(m, j)];
+    int max_k = AR[triIndex(i+1, j)];
+    for (int k = m+1; k <= max_k; k++) {
+        long long x = rowI[k-1] + AP[triIndex(k, j)];
+        if (x < min_val) {
+            m = k;
+            min_val = x;
+        }
+    }
+    AP[triIndex(i, j)] = min_val + getAW(i, j);
+    AR[triIndex(i, j)] = m;
+}
+
+void computeAPAR(int n) {
+    for (int i = 0; i <= n; i++) {
+        AP[triIndex(i, i)] = 0;
+        AR[triIndex(i, i)] = 0;
+    }
+    for (int i = 0; i < n; i++) {
+        AP[triIndex(i, i+1)] = getAW(i, i+1);
+        AR[triIndex(i, i+1)] = i+1;
+    }
+    for (int h = 2; h <= n; h++) {
+        for (int i = 0; i <= n - h; i++) {
+            computeCell(i, i + h);
+        }
+    }
+}
+
+Node* createTree(int L, int R) {
+    if (L < R) {
+        int k = AR[triIndex(L, R)];
+        Node* root = createNode(k, weights[k-1]);
+        root->left = createTree(L, k-1);
+        root->right = createTree(k, R);
+        return root;
+    }
+    return NULL;
+}
+
+int treeSize(Node* root) {
+    if (root == NULL) return 0;
+    return 1 + treeSize(root->left) + treeSize(root->right);
+}
+
+double weightedHeight(Node* root, int level) {
+    if (root == NULL) return 0;
+    return (double)root->weight * level +
+           weightedHeight(root->left, level + 1) +
+           weightedHeight(root->right, level + 1);
+}
+
+void freeTree(Node* root) {
+    if (root != NULL) {
+        freeTree(root->left);
+        freeTree(root->right);
+        free(root);
+    }
+}
+
+int sameTree(Node* a, Node* b) {
+    if (a == NULL || b == NULL) return a == b;
+    return a->key == b->key && a->weight == b->weight &&
+           sameTree(a->left, b->left) && sameTree(a->right, b->right);
+}
+
+// Применяет пакет новых весов и пересчитывает только затронутые клетки.
+// Клетка (i, j) зависит от (i, j') при j' < j и от строк ниже i, поэтому строки
+// идут от n-1 к 0, а в строке i - от первого затронутого j до n
+void applyUpdates(WeightUpdate* updates, int count, UpdateStats* stats) {
+    int n = N;
+    int minKey = n + 1;
+    for (int u = 0; u < count; u++) {
+        weights[updates[u].key - 1] = updates[u].weight;
+        if (updates[u].key < minKey) minKey = updates[u].key;
+    }
+    for (int i = minKey; i <= n; i++) {
+        prefixWeights[i] = prefixWeights[i-1] + weights[i-1];
+    }
+
+    for (int i = 0; i <= n; i++) nextChanged[i] = n + 1;
+    for (int u = 0; u < count; u++) {
+        int k = updates[u].key;
+        if (k < nextChanged[k-1]) nextChanged[k-1] = k;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        if (nextChanged[i+1] < nextChanged[i]) nextChanged[i] = nextChanged[i+1];
+    }
+
+    for (int i = n - 1; i >= 0; i--) {
+        int j = nextChanged[i];
+        if (j > n) continue;
+        if (j == i + 1) {
+            AP[triIndex(i, j)] = getAW(i, j);
+            stats->cellsRecomputed++;
+            j++;
+        }
+        for (; j <= n; j++) {
+            int oldRoot = AR[triIndex(i, j)];
+            computeCell(i, j);
+            if (AR[triIndex(i, j)] != oldRoot) stats->rootsChanged++;
+            stats->cellsRecomputed++;
+        }
+    }
+}
+
+// Проходит только по интервалам с измененными ключами: если корень интервала
+// остался прежним, вершина сохраняется (обновляется вес), иначе поддерево строится заново
+Node* repairTree(Node* root, int L, int R, UpdateStats* stats) {
+    if (L >= R || nextChanged[L] > R) return root;
+    int k = AR[triIndex(L, R)];
+    if (root->key != k) {
+        freeTree(root);
+        Node* rebuilt = createTree(L, R);
+        stats->nodesRebuilt += treeSize(rebuilt);
+        return rebuilt;
+    }
+    root->weight = weights[k-1];
+    root->left = repairTree(root->left, L, k-1, stats);
+    root->right = repairTree(root->right, k, R, stats);
+    return root;
+}
+
+double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 5000;
+    int rounds = (argc > 2) ? atoi(argv[2]) : 3;
+    if (n < 1 || rounds < 1) {
+        printf("Использование: %s [n] [раундов]\n", argv[0]);
+        return 1;
+    }
+    srand(time(NULL));
+
+    N = n;
+    size_t cells = ((size_t)n + 1) * ((size_t)n + 2) / 2;
+    AP = (long long*)malloc(cells * sizeof(long long));
+    AR = (int*)malloc(cells * sizeof(int));
+    prefixWeights = (long long*)malloc(((size_t)n + 1) * sizeof(long long));
+    weights = (long long*)malloc((size_t)n * sizeof(long long));
+    nextChanged = (int*)malloc(((size_t)n + 1) * sizeof(int));
+    long long* savedAP = (long long*)malloc(cells * sizeof(long long));
+    int* savedAR = (int*)malloc(cells * sizeof(int));
+    if (!AP || !AR || !prefixWeights || !weights || !nextChanged || !savedAP || !savedAR) {
+        printf("Ошибка: недостаточно памяти для n=%d\n", n);
+        return 1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        weights[i] = rand() % 100 + 1;
+    }
+
+    double start = nowSeconds();
+    computeAW(n);
+    computeAPAR(n);
+    Node* root = createTree(0, n);
+    double fullTime = nowSeconds() - start;
+    printf("n=%d, полное построение: %.4f с, клеток в таблице: %zu\n\n", n, fullTime, cells);
+
+    int batchSizes[] = {1, 10, 100};
+    int batchCount = sizeof(batchSizes) / sizeof(batchSizes[0]);
+    WeightUpdate* updates = (WeightUpdate*)malloc(batchSizes[batchCount - 1] * sizeof(WeightUpdate));
+    int allSame = 1;
+
+    printf("+--------+--------------+----------------+----------------+------------+------------+------------+\n");
+    printf("| %-6s | %-12s | %-14s | %-14s | %-10s | %-10s | %-10s |\n",
+           "Пакет", "Клеток, %", "Сменилось AR", "Перестроено", "Починка, с", "Полный, с", "Проверка");
+    printf("+--------+--------------+----------------+----------------+------------+------------+------------+\n");
+
+    for (int b = 0; b < batchCount; b++) {
+        for (int r = 0; r < rounds; r++) {
+            int count = batchSizes[b];
+            for (int u = 0; u < count; u++) {
+                updates[u].key = rand() % n + 1;
+                updates[u].weight = rand() % 100 + 1;
+            }
+
+            UpdateStats stats = {0, 0, 0};
+            start = nowSeconds();
+            applyUpdates(updates, count, &stats);
+            root = repairTree(root, 0, n, &stats);
+            double repairTime = nowSeconds() - start;
+
+            // Проверка: полный пересчет по тем же весам должен дать те же матрицы и дерево
+            memcpy(savedAP, AP, cells * sizeof(long long));
+            memcpy(savedAR, AR, cells * sizeof(int));
+            start = nowSeconds();
+            computeAW(n);
+            computeAPAR(n);
+            Node* reference = createTree(0, n);
+            double rebuildTime = nowSeconds() - start;
+            int same = memcmp(savedAP, AP, cells * sizeof(long long)) == 0 &&
+                       memcmp(savedAR, AR, cells * sizeof(int)) == 0 &&
+                       sameTree(root, reference);
+            allSame = allSame && same;
+            freeTree(reference);
+
+            printf("| %-6d | %12.2f | %14lld | %14d | %10.4f | %10.4f | %-10s |\n",
+                   count, 100.0 * stats.cellsRecomputed / cells, stats.rootsChanged,
+                   stats.nodesRebuilt, repairTime, rebuildTime, same ? "совпадает" : "ОШИБКА");
+        }
+    }
+    printf("+--------+--------------+----------------+----------------+------------+------------+------------+\n");
+    printf("AP[0,n]/AW[0,n] = %.6f, средневзвешенная высота = %.6f\n",
+           (double)AP[triIndex(0, n)] / getAW(0, n), weightedHeight(root, 1) / getAW(0, n));
+
+    freeTree(root);
+    free(updates);
+    free(AP);
+    free(AR);
+    free(prefixWeights);
+    free(weights);
+    free(nextChanged);
+    free(savedAP);
+    free(savedAR);
+    return allSame ? 0 : 1;
+}
@@ -0,0 +1,502 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+
+// Сравнение самоорганизующегося (splay) дерева с АВЛ и ДОП на Zipf-трассе.
+// Сборка: gcc -O2 splay.c -o splay -lm
+// Запуск: ./splay [n] [длина трассы] [параметр Zipf s]
+
+typedef struct Node {
+    int key;
+    long long weight;
+    struct Node *left;
+    struct Node *right;
+} Node;
+
+typedef struct Vertex {
+    int data;
+    struct Vertex *left;
+    struct Vertex *right;
+    int bal;
+} Vertex;
+
+// Счетчик сравнений ключей, общий для всех деревьев
+long long comparisons = 0;
+
+Node* createNode(int key, long long weight) {
+    Node* newNode = (Node*)malloc(sizeof(Node));
+    newNode->key = key;
+    newNode->weight = weight;
+    newNode->left = NULL;
+    newNode->right = NULL;
+    return newNode;
+}
+
+void freeTree(Node* root) {
+    if (root != NULL) {
+        freeTree(root->left);
+        freeTree(root->right);
+        free(root);
+    }
+}
+
+// ---------------- Генератор и Zipf-распределение ----------------
+
+unsigned long long rngState = 88172645463325252ULL;
+
+unsigned long long nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+double nextUniform() {
+    return (nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Вероятность ключа key равна 1/rank^s, ранги ключам раздаются случайной перестановкой,
+// чтобы "горячие" ключи не шли подряд
+void buildZipf(int n, double s, int* rankOfKey, double* prob, double* cdf) {
+    int* perm = (int*)malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) perm[i] = i;
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)(nextRandom() % (unsigned long long)(i + 1));
+        int t = perm[i]; perm[i] = perm[j]; perm[j] = t;
+    }
+
+    double total = 0;
+    for (int i = 0; i < n; i++) {
+        rankOfKey[i] = perm[i] + 1;
+        prob[i] = 1.0 / pow(rankOfKey[i], s);
+        total += prob[i];
+    }
+
+    double sum = 0;
+    for (int i = 0; i < n; i++) {
+        prob[i] /= total;
+        sum += prob[i];
+        cdf[i] = sum;
+    }
+    cdf[n - 1] = 1.0;
+    free(perm);
+}
+
+// Выборка ключа (1..n) бинарным поиском по функции распределения
+int sampleKey(double* cdf, int n) {
+    double u = nextUniform();
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (cdf[mid] < u) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo + 1;
+}
+
+// ---------------- Splay-дерево (нисходящий splay без рекурсии) ----------------
+
+// Нисходящий splay по Слитору-Тарьяну: ключ key (или последний посещенный)
+// поднимается в корень за один проход сверху вниз
+Node* splay(Node* t, int key) {
+    if (t == NULL) return NULL;
+
+    Node header = {0, 0, NULL, NULL};
+    Node* leftMax = &header;
+    Node* rightMin = &header;
+
+    for (;;) {
+        comparisons++;
+        if (key < t->key) {
+            if (t->left == NULL) break;
+            comparisons++;
+            if (key < t->left->key) {
+                // zig-zig: поворот вправо
+                Node* y = t->left;
+                t->left = y->right;
+                y->right = t;
+                t = y;
+                if (t->left == NULL) break;
+            }
+            // присоединяем t к правому дереву
+            rightMin->left = t;
+            rightMin = t;
+            t = t->left;
+        } else if (key > t->key) {
+            if (t->right == NULL) break;
+            comparisons++;
+            if (key > t->right->key) {
+                // zag-zag: поворот влево
+                Node* y = t->right;
+                t->right = y->left;
+                y->left = t;
+                t = y;
+                if (t->right == NULL) break;
+            }
+            // присоединяем t к левому дереву
+            leftMax->right = t;
+            leftMax = t;
+            t = t->right;
+        } else {
+            break;
+        }
+    }
+
+    // Сборка: левое дерево, t, правое дерево
+    leftMax->right = t->left;
+    rightMin->left = t->right;
+    t->left = header.right;
+    t->right = header.left;
+    return t;
+}
+
+Node* splayInsert(Node* root, int key) {
+    if (root == NULL) return createNode(key, 0);
+
+    root = splay(root, key);
+    if (root->key == key) return root;
+
+    Node* newNode = createNode(key, 0);
+    if (key < root->key) {
+        newNode->left = root->left;
+        newNode->right = root;
+        root->left = NULL;
+    } else {
+        newNode->right = root->right;
+        newNode->left = root;
+        root->right = NULL;
+    }
+    return newNode;
+}
+
+// ---------------- АВЛ-дерево (вставка как в Lab7) ----------------
+
+void LL_rotate(Vertex **p) {
+    Vertex *q = (*p)->left;
+    (*p)->bal = 0;
+    q->bal = 0;
+    (*p)->left = q->right;
+    q->right = *p;
+    *p = q;
+}
+
+void RR_rotate(Vertex **p) {
+    Vertex *q = (*p)->right;
+    (*p)->bal = 0;
+    q->bal = 0;
+    (*p)->right = q->left;
+    q->left = *p;
+    *p = q;
+}
+
+void LR_rotate(Vertex **p) {
+    Vertex *q = (*p)->left;
+    Vertex *r = q->right;
+    (*p)->bal = (r->bal < 0) ? 1 : 0;
+    q->bal = (r->bal > 0) ? -1 : 0;
+    r->bal = 0;
+    q->right = r->left;
+    (*p)->left = r->right;
+    r->left = q;
+    r->right = *p;
+    *p = r;
+}
+
+void RL_rotate(Vertex **p) {
+    Vertex *q = (*p)->right;
+    Vertex *r = q->left;
+    (*p)->bal = (r->bal > 0) ? -1 : 0;
+    q->bal = (r->bal < 0) ? 1 : 0;
+    r->bal = 0;
+    q->left = r->right;
+    (*p)->right = r->left;
+    r->right = q;
+    r->left = *p;
+    *p = r;
+}
+
+int insertAVL(int D, Vertex **p, int *Rost) {
+    if (*p == NULL) {
+        *p = (Vertex*)malloc(sizeof(Vertex));
+        if (*p == NULL) return 0;
+        (*p)->data = D;
+        (*p)->left = NULL;
+        (*p)->right = NULL;
+        (*p)->bal = 0;
+        *Rost = 1;
+        return 1;
+    }
+    else if ((*p)->data > D) {
+        if (!insertAVL(D, &((*p)->left), Rost)) return 0;
+        if (*Rost == 1) {
+            if ((*p)->bal > 0) {
+                (*p)->bal = 0;
+                *Rost = 0;
+            } else if ((*p)->bal == 0) {
+                (*p)->bal = -1;
+            } else {
+                if ((*p)->left->bal < 0) LL_rotate(p);
+                else LR_rotate(p);
+                *Rost = 0;
+            }
+        }
+    }
+    else if ((*p)->data < D) {
+        if (!insertAVL(D, &((*p)->right), Rost)) return 0;
+        if (*Rost == 1) {
+            if ((*p)->bal < 0) {
+                (*p)->bal = 0;
+                *Rost = 0;
+            } else if ((*p)->bal == 0) {
+                (*p)->bal = 1;
+            } else {
+                if ((*p)->right->bal > 0) RR_rotate(p);
+                else RL_rotate(p);
+                *Rost = 0;
+            }
+        }
+    }
+    else {
+        return 0;
+    }
+    return 1;
+}
+
+void freeAVL(Vertex *root) {
+    if (root != NULL) {
+        freeAVL(root->left);
+        freeAVL(root->right);
+        free(root);
+    }
+}
+
+Vertex* searchAVL(Vertex* root, int key) {
+    while (root != NULL) {
+        comparisons++;
+        if (key < root->data) root = root->left;
+        else if (key > root->data) root = root->right;
+        else return root;
+    }
+    return NULL;
+}
+
+// ---------------- ДОП по истинным весам (как в Lab8) ----------------
+
+// Индекс элемента (i, j), 0 <= i <= j <= n, в упакованном треугольнике
+static inline size_t triIndex(int n, int i, int j) {
+    return (size_t)i * (2 * (size_t)n + 3 - i) / 2 + (j - i);
+}
+
+// AP и AR хранятся упакованным верхним треугольником, как в 1.c, а AW заменяют
+// префиксные суммы весов: трасса строится для нескольких тысяч ключей, и полные
+// матрицы (n+1)x(n+1) заняли бы втрое больше памяти
+Node* buildOptimal(long long* weights, int n) {
+    size_t dim = (size_t)n + 1;
+    size_t cells = dim * (dim + 1) / 2;
+    long long* prefix = (long long*)malloc(dim * sizeof(long long));
+    long long* AP = (long long*)malloc(cells * sizeof(long long));
+    int* AR = (int*)malloc(cells * sizeof(int));
+    if (!prefix || !AP || !AR) {
+        printf("Ошибка: недостаточно памяти для матриц ДОП (n=%d)\n", n);
+        exit(1);
+    }
+
+    prefix[0] = 0;
+    for (int i = 0; i < n; i++) prefix[i + 1] = prefix[i] + weights[i];
+
+    for (int i = 0; i <= n; i++) {
+        AP[triIndex(n, i, i)] = 0;
+        AR[triIndex(n, i, i)] = 0;
+    }
+    for (int i = 0; i < n; i++) {
+        AP[triIndex(n, i, i + 1)] = weights[i];
+        AR[triIndex(n, i, i + 1)] = i + 1;
+    }
+
+    for (int h = 2; h <= n; h++) {
+        for (int i = 0; i <= n - h; i++) {
+            int j = i + h;
+            // Строка i непрерывна: AP[i][k-1] идут подряд
+            long long* rowI = AP + triIndex(n, i, i) - i;
+            int m = AR[triIndex(n, i, j - 1)];
+            long long minVal = rowI[m - 1] + AP[triIndex(n, m, j)];
+            int maxK = AR[triIndex(n, i + 1, j)];
+            for (int k = m + 1; k <= maxK; k++) {
+                long long x = rowI[k - 1] + AP[triIndex(n, k, j)];
+                if (x < minVal) {
+                    m = k;
+                    minVal = x;
+                }
+            }
+            AP[triIndex(n, i, j)] = minVal + (prefix[j] - prefix[i]);
+            AR[triIndex(n, i, j)] = m;
+        }
+    }
+
+    // Дерево строится по AR явным стеком интервалов
+    Node* root = NULL;
+    int* stackL = (int*)malloc(dim * sizeof(int));
+    int* stackR = (int*)malloc(dim * sizeof(int));
+    Node*** stackSlot = (Node***)malloc(dim * sizeof(Node**));
+    int top = 0;
+    stackL[top] = 0; stackR[top] = n; stackSlot[top] = &root; top++;
+    while (top > 0) {
+        top--;
+        int L = stackL[top], R = stackR[top];
+        Node** slot = stackSlot[top];
+        if (L >= R) continue;
+        int k = AR[triIndex(n, L, R)];
+        *slot = createNode(k, weights[k - 1]);
+        stackL[top] = L; stackR[top] = k - 1; stackSlot[top] = &(*slot)->left; top++;
+        stackL[top] = k; stackR[top] = R; stackSlot[top] = &(*slot)->right; top++;
+    }
+
+    free(stackL);
+    free(stackR);
+    free(stackSlot);
+    free(prefix);
+    free(AP);
+    free(AR);
+    return root;
+}
+
+Node* searchStatic(Node* root, int key) {
+    while (root != NULL) {
+        comparisons++;
+        if (key < root->key) root = root->left;
+        else if (key > root->key) root = root->right;
+        else return root;
+    }
+    return NULL;
+}
+
+// ---------------- Прогон трассы ----------------
+
+double nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+typedef struct {
+    double cmpPerLookup;
+    double nsPerLookup;
+} RunResult;
+
+RunResult runSplay(Node** root, int* trace, int m) {
+    RunResult r;
+    long long found = 0;
+    comparisons = 0;
+    double start = nowNs();
+    for (int i = 0; i < m; i++) {
+        *root = splay(*root, trace[i]);
+        found += ((*root)->key == trace[i]);
+    }
+    r.nsPerLookup = (nowNs() - start) / m;
+    r.cmpPerLookup = (double)comparisons / m;
+    if (found != m) printf("Ошибка: splay-дерево нашло %lld из %d ключей\n", found, m);
+    return r;
+}
+
+RunResult runAVL(Vertex* root, int* trace, int m) {
+    RunResult r;
+    long long found = 0;
+    comparisons = 0;
+    double start = nowNs();
+    for (int i = 0; i < m; i++) {
+        found += (searchAVL(root, trace[i]) != NULL);
+    }
+    r.nsPerLookup = (nowNs() - start) / m;
+    r.cmpPerLookup = (double)comparisons / m;
+    if (found != m) printf("Ошибка: АВЛ-дерево нашло %lld из %d ключей\n", found, m);
+    return r;
+}
+
+RunResult runStatic(Node* root, int* trace, int m) {
+    RunResult r;
+    long long found = 0;
+    comparisons = 0;
+    double start = nowNs();
+    for (int i = 0; i < m; i++) {
+        found += (searchStatic(root, trace[i]) != NULL);
+    }
+    r.nsPerLookup = (nowNs() - start) / m;
+    r.cmpPerLookup = (double)comparisons / m;
+    if (found != m) printf("Ошибка: ДОП нашло %lld из %d ключей\n", found, m);
+    return r;
+}
+
+void printRow(const char* name, RunResult r) {
+    printf("| %-22s | %14.3f | %12.1f |\n", name, r.cmpPerLookup, r.nsPerLookup);
+}
+
+void printSeparator() {
+    printf("+------------------------+----------------+--------------+\n");
+}
+
+void runScenario(const char* title, int n, int* trace, int m, long long* weights) {
+    Node* splayRoot = NULL;
+    Vertex* avlRoot = NULL;
+    for (int key = 1; key <= n; key++) {
+        int rost = 1;
+        splayRoot = splayInsert(splayRoot, key);
+        insertAVL(key, &avlRoot, &rost);
+    }
+    Node* optimalRoot = buildOptimal(weights, n);
+
+    printf("\n%s\n", title);
+    printSeparator();
+    printf("| %-22s | %14s | %12s |\n", "Дерево", "Сравн./поиск", "нс/поиск");
+    printSeparator();
+    printRow("Splay", runSplay(&splayRoot, trace, m));
+    printRow("АВЛ", runAVL(avlRoot, trace, m));
+    printRow("ДОП (истинные веса)", runStatic(optimalRoot, trace, m));
+    printSeparator();
+
+    freeTree(splayRoot);
+    freeAVL(avlRoot);
+    freeTree(optimalRoot);
+}
+
+int main(int argc, char* argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 2000;
+    int m = (argc > 2) ? atoi(argv[2]) : 2000000;
+    double s = (argc > 3) ? atof(argv[3]) : 1.0;
+    if (n < 1 || m < 1) {
+        printf("Использование: %s [n] [длина трассы] [s]\n", argv[0]);
+        return 1;
+    }
+
+    rngState ^= (unsigned long long)time(NULL);
+
+    int* rankOfKey = (int*)malloc(n * sizeof(int));
+    double* prob = (double*)malloc(n * sizeof(double));
+    double* cdf = (double*)malloc(n * sizeof(double));
+    long long* weights = (long long*)malloc(n * sizeof(long long));
+    int* trace = (int*)malloc((size_t)m * sizeof(int));
+
+    printf("Ключей: %d, длина трассы: %d, Zipf s = %.2f\n", n, m, s);
+
+    // Сценарий 1: распределение неизменно на всей трассе
+    buildZipf(n, s, rankOfKey, prob, cdf);
+    for (int i = 0; i < n; i++) {
+        weights[i] = (long long)(prob[i] * 1e9) + 1;
+    }
+    for (int i = 0; i < m; i++) trace[i] = sampleKey(cdf, n);
+    runScenario("Стационарная трасса", n, trace, m, weights);
+
+    // Сценарий 2: ДОП построено по весам первой половины,
+    // а во второй половине "горячие" ключи меняются
+    for (int i = 0; i < m / 2; i++) trace[i] = sampleKey(cdf, n);
+    buildZipf(n, s, rankOfKey, prob, cdf);
+    for (int i = m / 2; i < m; i++) trace[i] = sampleKey(cdf, n);
+    runScenario("Дрейф распределения в середине трассы (ДОП по старым весам)", n, trace, m, weights);
+
+    free(rankOfKey);
+    free(prob);
+    free(cdf);
+    free(weights);
+    free(trace);
+    return 0;
+}
@@ -3,13 +3,18 @@
 #include <limits.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
-typedef struct Node {
-    int key;
-    int weight;
-    struct Node* left;
-    struct Node* right;
-} Node;
+#include "tree_common.h"
+
+// Сборка: gcc -O2 -pthread 1.c -o task1 -lm
+
+#define OPTIMAL_MIN_PARALLEL_N 512
+#define OPTIMAL_MIN_GRAIN 64
+#define OPTIMAL_CHUNKS_PER_THREAD 8
 
 typedef struct BSTCharacteristics {
     int size;
@@ -18,14 +23,14 @@ typedef struct BSTCharacteristics {
     double weighted_height;
 } BSTCharacteristics;
 
-// Функция для создания нового узла
-Node* create_node(int key, int weight) {
-    Node* newNode = (Node*)malloc(sizeof(Node));
-    newNode->key = key;
-    newNode->weight = weight;
-    newNode->left = NULL;
-    newNode->right = NULL;
-    return newNode;
+// Число потоков для вычисления матриц оптимального дерева
+int optimal_threads = 1;
+
+// Настенное время: ДОП считается в несколько потоков, и clock() сложил бы их время
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
 }
 
 // Обход дерева слева направо (in-order)
@@ -50,15 +55,6 @@ void calculate_characteristics(Node* root, int depth, BSTCharacteristics* chars)
     calculate_characteristics(root->right, depth + 1, chars);
 }
 
-// Освобождение памяти дерева
-void free_tree(Node* root) {
-    if (root != NULL) {
-        free_tree(root->left);
-        free_tree(root->right);
-        free(root);
-    }
-}
-
 // Функция для обмена элементов
 void swap(int* a, int* b) {
     int temp = *a;
@@ -66,174 +62,177 @@ void swap(int* a, int* b) {
     *b = temp;
 }
 
-// Алгоритм A1 - сортировка по убыванию весов
-Node* algorithm_a1(int* keys, int* weights, int n) {
-    // Создаем массив индексов и сортируем по убыванию весов
-    int* indices = (int*)malloc(n * sizeof(int));
-    for (int i = 0; i < n; i++) indices[i] = i;
-    
-    // Сортировка пузырьком по убыванию весов
-    for (int i = 0; i < n - 1; i++) {
-        for (int j = 0; j < n - i - 1; j++) {
-            if (weights[indices[j]] < weights[indices[j + 1]]) {
-                swap(&indices[j], &indices[j + 1]);
-            }
-        }
-    }
+// A2 с весами промахов: ключи уже упорядочены, gaps[i] (0 <= i <= n) - вес поиска
+// значения между keys[i-1] и keys[i]
+Node* algorithm_a2_with_gaps(int* keys, int* weights, int* gaps, int n) {
+    if (n == 0) return NULL;
+    long long* prefix = (long long*)malloc(((size_t)n + 1) * sizeof(long long));
+    long long* gap_prefix = (long long*)malloc(((size_t)n + 2) * sizeof(long long));
+    prefix[0] = 0;
+    gap_prefix[0] = 0;
+    for (int i = 0; i < n; i++) prefix[i + 1] = prefix[i] + weights[i];
+    for (int i = 0; i <= n; i++) gap_prefix[i + 1] = gap_prefix[i] + gaps[i];
     
-    // Построение дерева
-    Node* root = NULL;
-    for (int i = 0; i < n; i++) {
-        Node* newNode = create_node(keys[indices[i]], weights[indices[i]]);
-        if (root == NULL) {
-            root = newNode;
-        } else {
-            // Вставка как в BST (по ключу)
-            Node* current = root;
-            Node* parent = NULL;
-            while (current != NULL) {
-                parent = current;
-                if (newNode->key < current->key) {
-                    current = current->left;
-                } else {
-                    current = current->right;
-                }
-            }
-            if (newNode->key < parent->key) {
-                parent->left = newNode;
-            } else {
-                parent->right = newNode;
-            }
-        }
-    }
+    Node* root = algorithm_a2_build(keys, weights, prefix, gap_prefix, n);
     
-    free(indices);
+    free(prefix);
+    free(gap_prefix);
     return root;
 }
 
-// Алгоритм A2 - рекурсивное построение с балансировкой по весам
-Node* algorithm_a2_recursive(int* keys, int* weights, int left, int right) {
-    if (left > right) return NULL;
-    
-    if (left == right) {
-        return create_node(keys[left], weights[left]);
-    }
-    
-    // Вычисляем общий вес
-    int total_weight = 0;
-    for (int i = left; i <= right; i++) {
-        total_weight += weights[i];
-    }
-    
-    // Находим корень - первый узел, где сумма весов превышает половину
-    int sum = 0;
-    int root_index = left;
-    for (int i = left; i <= right; i++) {
-        if (sum < total_weight / 2 && sum + weights[i] > total_weight / 2) {
-            root_index = i;
-            break;
+// Оценка памяти под упакованные матрицы AP и AR (в байтах)
+double estimate_optimal_memory(int n) {
+    double cells = ((double)n + 1) * ((double)n + 2) / 2;
+    return cells * (sizeof(long long) + sizeof(int)) + ((double)n + 2) * 2 * sizeof(long long);
+}
+
+// Общее состояние вычисления матриц, разделяемое потоками
+typedef struct OptimalContext {
+    int n;
+    long long* AP;
+    int* AR;
+    long long* prefix;
+    long long* gap_prefix;
+    int threads;
+    atomic_int* next_cell;
+    pthread_barrier_t barrier;
+} OptimalContext;
+
+static inline void optimal_cell(OptimalContext* ctx, int i, int j) {
+    int n = ctx->n;
+    long long* AP = ctx->AP;
+    int* AR = ctx->AR;
+    long long* row_i = AP + tri_index(n, i, i) - i;
+    
+    int m = AR[tri_index(n, i, j - 1)];
+    long long min_val = row_i[m - 1] + AP[tri_index(n, m, j)];
+    
+    int max_k = AR[tri_index(n, i + 1, j)];
+    for (int k = m + 1; k <= max_k; k++) {
+        long long x = row_i[k - 1] + AP[tri_index(n, k, j)];
+        if (x < min_val) {
+            m = k;
+            min_val = x;
         }
-        sum += weights[i];
     }
     
-    Node* root = create_node(keys[root_index], weights[root_index]);
-    root->left = algorithm_a2_recursive(keys, weights, left, root_index - 1);
-    root->right = algorithm_a2_recursive(keys, weights, root_index + 1, right);
-    
-    return root;
+    AP[tri_index(n, i, j)] = min_val + (ctx->prefix[j] - ctx->prefix[i])
+                           + (ctx->gap_prefix[j + 1] - ctx->gap_prefix[i]);
+    AR[tri_index(n, i, j)] = m;
 }
 
-Node* algorithm_a2(int* keys, int* weights, int n) {
-    // Создаем массивы для сортировки по ключам
-    int* indices = (int*)malloc(n * sizeof(int));
-    for (int i = 0; i < n; i++) indices[i] = i;
-    
-    // Сортировка пузырьком по ключам
-    for (int i = 0; i < n - 1; i++) {
-        for (int j = 0; j < n - i - 1; j++) {
-            if (keys[indices[j]] > keys[indices[j + 1]]) {
-                swap(&indices[j], &indices[j + 1]);
+// Поток обрабатывает порции клеток диагонали h, затем ждет остальных на барьере
+void* optimal_diagonal_worker(void* arg) {
+    OptimalContext* ctx = (OptimalContext*)arg;
+    int n = ctx->n;
+    for (int h = 2; h <= n; h++) {
+        int cells = n - h + 1;
+        int grain = cells / (ctx->threads * OPTIMAL_CHUNKS_PER_THREAD);
+        if (grain < OPTIMAL_MIN_GRAIN) grain = OPTIMAL_MIN_GRAIN;
+        
+        for (;;) {
+            int first = atomic_fetch_add_explicit(&ctx->next_cell[h], grain, memory_order_relaxed);
+            if (first >= cells) break;
+            int last = (first + grain < cells) ? first + grain : cells;
+            for (int i = first; i < last; i++) {
+                optimal_cell(ctx, i, i + h);
             }
         }
+        pthread_barrier_wait(&ctx->barrier);
     }
-    
-    // Создаем отсортированные массивы
-    int* sorted_keys = (int*)malloc(n * sizeof(int));
-    int* sorted_weights = (int*)malloc(n * sizeof(int));
-    for (int i = 0; i < n; i++) {
-        sorted_keys[i] = keys[indices[i]];
-        sorted_weights[i] = weights[indices[i]];
-    }
-    
-    Node* root = algorithm_a2_recursive(sorted_keys, sorted_weights, 0, n - 1);
-    
-    free(indices);
-    free(sorted_keys);
-    free(sorted_weights);
-    return root;
+    return NULL;
 }
 
-// Оптимальное дерево поиска (алгоритм Кнута) с возвратом матриц для проверки
-Node* optimal_bst_with_check(int* keys, int* weights, int n, double* ap_value, double* aw_value) {
+// Оптимальное дерево поиска (алгоритм Кнута) с весами промахов gaps[0..n] (NULL - без них)
+// и возвратом матриц для проверки. Ключи должны быть упорядочены
+Node* optimal_bst_with_gaps(int* keys, int* weights, int* gaps, int n, double* ap_value, double* aw_value) {
     if (n == 0) return NULL;
     
-    // Выделяем память для матриц
-    double** AW = (double**)malloc((n + 1) * sizeof(double*));
-    double** AP = (double**)malloc((n + 1) * sizeof(double*));
-    int** AR = (int**)malloc((n + 1) * sizeof(int*));
+    // Проверяем объем памяти до выделения, чтобы слишком большой n отклонялся сразу
+    double need = estimate_optimal_memory(n);
+    double available = (double)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGE_SIZE);
+    if (available > 0 && need > available) {
+        printf("Ошибка: для n=%d нужно %.1f МБ, доступно %.1f МБ\n",
+               n, need / (1 << 20), available / (1 << 20));
+        return NULL;
+    }
     
-    for (int i = 0; i <= n; i++) {
-        AW[i] = (double*)malloc((n + 1) * sizeof(double));
-        AP[i] = (double*)malloc((n + 1) * sizeof(double));
-        AR[i] = (int*)malloc((n + 1) * sizeof(int));
+    // Верхние треугольники AP и AR хранятся одним непрерывным блоком,
+    // AW[i][j] = prefix[j] - prefix[i] + gap_prefix[j + 1] - gap_prefix[i]
+    OptimalContext ctx;
+    ctx.n = n;
+    size_t cells = ((size_t)n + 1) * ((size_t)n + 2) / 2;
+    ctx.AP = (long long*)malloc(cells * sizeof(long long));
+    ctx.AR = (int*)malloc(cells * sizeof(int));
+    ctx.prefix = (long long*)malloc(((size_t)n + 1) * sizeof(long long));
+    ctx.gap_prefix = (long long*)malloc(((size_t)n + 2) * sizeof(long long));
+    if (!ctx.AP || !ctx.AR || !ctx.prefix || !ctx.gap_prefix) {
+        printf("Ошибка: не удалось выделить %.1f МБ\n", need / (1 << 20));
+        free(ctx.AP);
+        free(ctx.AR);
+        free(ctx.prefix);
+        free(ctx.gap_prefix);
+        return NULL;
     }
+    long long* AP = ctx.AP;
+    int* AR = ctx.AR;
+    long long* prefix = ctx.prefix;
+    long long* gap_prefix = ctx.gap_prefix;
     
-    // Инициализация матрицы весов
+    // Префиксные суммы весов вместо матрицы AW
+    prefix[0] = 0;
+    for (int i = 0; i < n; i++) {
+        prefix[i + 1] = prefix[i] + weights[i];
+    }
+    gap_prefix[0] = 0;
     for (int i = 0; i <= n; i++) {
-        for (int j = i + 1; j <= n; j++) {
-            if (j == i + 1) {
-                AW[i][j] = weights[i];
-            } else {
-                AW[i][j] = AW[i][j - 1] + weights[j - 1];
-            }
-        }
+        gap_prefix[i + 1] = gap_prefix[i] + (gaps != NULL ? gaps[i] : 0);
     }
     
-    // Инициализация для h = 1
+    // Инициализация для h = 0 и h = 1; AP[i][i] = 0 - промах в лакуне i
+    // стоит столько сравнений, сколько было сделано до нее
+    for (int i = 0; i <= n; i++) {
+        AP[tri_index(n, i, i)] = 0;
+        AR[tri_index(n, i, i)] = 0;
+    }
     for (int i = 0; i < n; i++) {
         int j = i + 1;
-        AP[i][j] = AW[i][j];
-        AR[i][j] = j;
+        AP[tri_index(n, i, j)] = prefix[j] - prefix[i] + gap_prefix[j + 1] - gap_prefix[i];
+        AR[tri_index(n, i, j)] = j;
     }
     
-    // Вычисление для h > 1
-    for (int h = 2; h <= n; h++) {
-        for (int i = 0; i <= n - h; i++) {
-            int j = i + h;
-            int m = AR[i][j - 1];
-            double min_val = AP[i][m - 1] + AP[m][j];
-            
-            for (int k = m + 1; k <= AR[i + 1][j]; k++) {
-                double x = AP[i][k - 1] + AP[k][j];
-                if (x < min_val) {
-                    m = k;
-                    min_val = x;
-                }
+    // Вычисление для h > 1: диагонали по очереди, клетки диагонали - параллельно
+    ctx.threads = optimal_threads;
+    if (ctx.threads <= 1 || n < OPTIMAL_MIN_PARALLEL_N) {
+        for (int h = 2; h <= n; h++) {
+            for (int i = 0; i <= n - h; i++) {
+                optimal_cell(&ctx, i, i + h);
             }
-            
-            AP[i][j] = min_val + AW[i][j];
-            AR[i][j] = m;
         }
+    } else {
+        ctx.next_cell = (atomic_int*)calloc(n + 1, sizeof(atomic_int));
+        pthread_barrier_init(&ctx.barrier, NULL, ctx.threads);
+        pthread_t* threads = (pthread_t*)malloc(ctx.threads * sizeof(pthread_t));
+        for (int t = 1; t < ctx.threads; t++) {
+            pthread_create(&threads[t], NULL, optimal_diagonal_worker, &ctx);
+        }
+        optimal_diagonal_worker(&ctx);
+        for (int t = 1; t < ctx.threads; t++) {
+            pthread_join(threads[t], NULL);
+        }
+        pthread_barrier_destroy(&ctx.barrier);
+        free(threads);
+        free((void*)ctx.next_cell);
     }
     
     // Сохраняем значения для проверки
-    *ap_value = AP[0][n];
-    *aw_value = AW[0][n];
+    *ap_value = (double)AP[tri_index(n, 0, n)];
+    *aw_value = (double)(prefix[n] + gap_prefix[n + 1]);
     
     Node* build_tree(int L, int R) {
         if (L >= R) return NULL;
         
-        int k = AR[L][R];
+        int k = AR[tri_index(n, L, R)];
         Node* root = create_node(keys[k - 1], weights[k - 1]);
         root->left = build_tree(L, k - 1);
         root->right = build_tree(k, R);
@@ -244,24 +243,292 @@ Node* optimal_bst_with_check(int* keys, int* weights, int n, double* ap_value, d
     Node* root = build_tree(0, n);
     
     // Освобождение памяти матриц
-    for (int i = 0; i <= n; i++) {
-        free(AW[i]);
-        free(AP[i]);
-        free(AR[i]);
-    }
-    free(AW);
     free(AP);
     free(AR);
+    free(prefix);
+    free(gap_prefix);
     
     return root;
 }
 
+Node* optimal_bst_with_check(int* keys, int* weights, int n, double* ap_value, double* aw_value) {
+    return optimal_bst_with_gaps(keys, weights, NULL, n, ap_value, aw_value);
+}
+
 // Обертка для обратной совместимости
 Node* optimal_bst(int* keys, int* weights, int n) {
     double ap, aw;
     return optimal_bst_with_check(keys, weights, n, &ap, &aw);
 }
 
+// Алгоритм Гарсиа-Уокса: оптимальное алфавитное дерево, когда веса есть только у листьев.
+// Ключи - листья в порядке возрастания, внутренняя вершина хранит наибольший ключ
+// левого поддерева (поиск: x <= key - налево). Фаза 1 объединяет веса, фаза 2
+// находит глубины листьев, фаза 3 строит по глубинам дерево с исходным порядком листьев.
+// Время O(n log n) при любых весах, в том числе монотонных
+Node* garsia_wachs(int* keys, int* weights, int n) {
+    if (n == 0) return NULL;
+    if (n == 1) return create_node(keys[0], weights[0]);
+    
+    // Сортировка по ключам, как в A2
+    KeyRecord* records = (KeyRecord*)malloc(n * sizeof(KeyRecord));
+    unsigned* sort_key = (unsigned*)malloc(n * sizeof(unsigned));
+    for (int i = 0; i < n; i++) {
+        records[i].key = keys[i];
+        records[i].weight = weights[i];
+        sort_key[i] = order_key(keys[i]);
+    }
+    radix_sort_records(records, sort_key, n);
+    
+    // Фаза 1. Дерево объединений: листья 0..n-1, внутренние вершины n..2n-2
+    int total_nodes = 2 * n - 1;
+    int* child_left = (int*)malloc(total_nodes * sizeof(int));
+    int* child_right = (int*)malloc(total_nodes * sizeof(int));
+    int next_node = n;
+    
+    // Рабочая последовательность - декартово дерево по неявному ключу (позиции):
+    // удаление пары, поиск места для суммы и вставка - O(log n), всего O(n log n).
+    // Элемент 0 - пустое поддерево; за время работы создается не больше 2n элементов
+    int capacity = 2 * n + 1;
+    long long* seq_weight = (long long*)malloc(capacity * sizeof(long long));
+    long long* seq_max = (long long*)malloc(capacity * sizeof(long long));
+    int* seq_node = (int*)malloc(capacity * sizeof(int));
+    int* seq_left = (int*)malloc(capacity * sizeof(int));
+    int* seq_right = (int*)malloc(capacity * sizeof(int));
+    int* seq_size = (int*)malloc(capacity * sizeof(int));
+    unsigned* seq_priority = (unsigned*)malloc(capacity * sizeof(unsigned));
+    int seq_count = 1;
+    unsigned random_state = 2463534242u;
+    seq_max[0] = -1;
+    seq_size[0] = 0;
+    
+    int seq_new(long long weight, int node) {
+        int v = seq_count++;
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 17;
+        random_state ^= random_state << 5;
+        seq_weight[v] = seq_max[v] = weight;
+        seq_node[v] = node;
+        seq_left[v] = seq_right[v] = 0;
+        seq_size[v] = 1;
+        seq_priority[v] = random_state;
+        return v;
+    }
+    
+    void seq_update(int v) {
+        int l = seq_left[v], r = seq_right[v];
+        seq_size[v] = seq_size[l] + 1 + seq_size[r];
+        long long m = seq_weight[v];
+        if (seq_max[l] > m) m = seq_max[l];
+        if (seq_max[r] > m) m = seq_max[r];
+        seq_max[v] = m;
+    }
+    
+    // Первые k элементов v уходят в *a, остальные - в *b
+    void seq_split(int v, int k, int* a, int* b) {
+        if (v == 0) {
+            *a = *b = 0;
+        } else if (seq_size[seq_left[v]] < k) {
+            seq_split(seq_right[v], k - seq_size[seq_left[v]] - 1, &seq_right[v], b);
+            seq_update(v);
+            *a = v;
+        } else {
+            seq_split(seq_left[v], k, a, &seq_left[v]);
+            seq_update(v);
+            *b = v;
+        }
+    }
+    
+    int seq_merge(int a, int b) {
+        if (a == 0) return b;
+        if (b == 0) return a;
+        if (seq_priority[a] > seq_priority[b]) {
+            seq_right[a] = seq_merge(seq_right[a], b);
+            seq_update(a);
+            return a;
+        }
+        seq_left[b] = seq_merge(a, seq_left[b]);
+        seq_update(b);
+        return b;
+    }
+    
+    int seq_at(int v, int k) {
+        for (;;) {
+            int left_size = seq_size[seq_left[v]];
+            if (k == left_size) return v;
+            if (k < left_size) {
+                v = seq_left[v];
+            } else {
+                k -= left_size + 1;
+                v = seq_right[v];
+            }
+        }
+    }
+    
+    // Позиция самого правого элемента с весом не меньше sum
+    int seq_rightmost_at_least(int v, long long sum) {
+        int offset = 0;
+        for (;;) {
+            if (seq_max[seq_right[v]] >= sum) {
+                offset += seq_size[seq_left[v]] + 1;
+                v = seq_right[v];
+            } else if (seq_weight[v] >= sum) {
+                return offset + seq_size[seq_left[v]];
+            } else {
+                v = seq_left[v];
+            }
+        }
+    }
+    
+    // seq[0] - ограничитель с бесконечным весом
+    int seq_root = seq_new(LLONG_MAX, -1);
+    int t = 1;
+    
+    long long weight_at(int k) {
+        return seq_weight[seq_at(seq_root, k)];
+    }
+    
+    // Объединяет seq[k-1] и seq[k], затем сдвигает сумму влево за все меньшие веса
+    void combine(int k) {
+        int first = seq_at(seq_root, k - 1), second = seq_at(seq_root, k);
+        long long sum = seq_weight[first] + seq_weight[second];
+        int node = next_node++;
+        child_left[node] = seq_node[first];
+        child_right[node] = seq_node[second];
+        
+        int before, pair, after;
+        seq_split(seq_root, k - 1, &before, &pair);
+        seq_split(pair, 2, &pair, &after);
+        t--;
+        
+        // Ограничитель не меньше любой суммы, поэтому место всегда находится
+        int j = seq_rightmost_at_least(before, sum) + 1;
+        int head, tail;
+        seq_split(before, j, &head, &tail);
+        seq_root = seq_merge(seq_merge(head, seq_new(sum, node)), seq_merge(tail, after));
+        
+        // Сдвинутая сумма могла сделать объединимой пару левее
+        while (j >= 3 && weight_at(j - 2) <= weight_at(j)) {
+            int right_part = t - j;
+            combine(j - 1);
+            j = t - right_part;
+        }
+    }
+    
+    for (int i = 0; i < n; i++) {
+        seq_root = seq_merge(seq_root, seq_new(records[i].weight, i));
+        t++;
+        while (t >= 4 && weight_at(t - 3) <= weight_at(t - 1)) {
+            combine(t - 2);
+        }
+    }
+    while (t > 2) {
+        combine(t - 1);
+    }
+    int combined_root = seq_node[seq_at(seq_root, 1)];
+    
+    // Фаза 2. Глубины листьев в дереве объединений (обход стеком)
+    int* depth = (int*)malloc(total_nodes * sizeof(int));
+    int* stack = (int*)malloc(total_nodes * sizeof(int));
+    int top = 0;
+    depth[combined_root] = 0;
+    stack[top++] = combined_root;
+    while (top > 0) {
+        int v = stack[--top];
+        if (v >= n) {
+            depth[child_left[v]] = depth[v] + 1;
+            depth[child_right[v]] = depth[v] + 1;
+            stack[top++] = child_left[v];
+            stack[top++] = child_right[v];
+        }
+    }
+    
+    // Фаза 3. Листья слева направо; две соседние вершины одной глубины сливаются
+    Node** tree_stack = (Node**)malloc(n * sizeof(Node*));
+    int* tree_depth = (int*)malloc(n * sizeof(int));
+    int* tree_max_key = (int*)malloc(n * sizeof(int));
+    top = 0;
+    for (int i = 0; i < n; i++) {
+        tree_stack[top] = create_node(records[i].key, records[i].weight);
+        tree_depth[top] = depth[i];
+        tree_max_key[top] = records[i].key;
+        top++;
+        while (top >= 2 && tree_depth[top - 1] == tree_depth[top - 2]) {
+            Node* parent = create_node(tree_max_key[top - 2], 0);
+            parent->left = tree_stack[top - 2];
+            parent->right = tree_stack[top - 1];
+            tree_stack[top - 2] = parent;
+            tree_depth[top - 2]--;
+            tree_max_key[top - 2] = tree_max_key[top - 1];
+            top--;
+        }
+    }
+    Node* root = tree_stack[0];
+    
+    free(records);
+    free(sort_key);
+    free(child_left);
+    free(child_right);
+    free(seq_weight);
+    free(seq_max);
+    free(seq_node);
+    free(seq_left);
+    free(seq_right);
+    free(seq_size);
+    free(seq_priority);
+    free(depth);
+    free(stack);
+    free(tree_stack);
+    free(tree_depth);
+    free(tree_max_key);
+    return root;
+}
+
+// Характеристики алфавитного дерева: учитываются только листья, глубина листа -
+// число сравнений на пути к нему (корень-лист дает 0)
+void calculate_leaf_characteristics(Node* root, int depth, BSTCharacteristics* chars) {
+    if (root == NULL) return;
+    
+    if (root->left == NULL && root->right == NULL) {
+        chars->size++;
+        chars->control_sum += root->key;
+        chars->height = (depth > chars->height) ? depth : chars->height;
+        chars->weighted_height += root->weight * depth;
+        return;
+    }
+    
+    calculate_leaf_characteristics(root->left, depth + 1, chars);
+    calculate_leaf_characteristics(root->right, depth + 1, chars);
+}
+
+// Ожидаемое число сравнений для успешного и неуспешного поиска (суммы с весами).
+// Промах в лакуне стоит столько сравнений, каков уровень вершины без нужного потомка;
+// пустые ссылки встречаются при обходе в порядке лакун gaps[0..n]
+void calculate_search_costs(Node* root, int* gaps, double* hit_cost, double* miss_cost) {
+    int gap_index = 0;
+    
+    void visit(Node* p, int depth) {
+        if (p == NULL) {
+            *miss_cost += (double)gaps[gap_index++] * (depth - 1);
+            return;
+        }
+        *hit_cost += (double)p->weight * depth;
+        visit(p->left, depth + 1);
+        visit(p->right, depth + 1);
+    }
+    
+    *hit_cost = 0;
+    *miss_cost = 0;
+    visit(root, 1);
+}
+
+void print_gap_row(const char* algorithm, Node* root, int* gaps, double hit_weight, double miss_weight) {
+    double hit_cost, miss_cost;
+    calculate_search_costs(root, gaps, &hit_cost, &miss_cost);
+    printf("| %-15s | %-11.4f | %-11.4f | %-11.4f |\n", algorithm, hit_cost / hit_weight,
+           miss_cost / miss_weight, (hit_cost + miss_cost) / (hit_weight + miss_weight));
+}
+
 void print_separator() {
     printf("+-----------------+-----------+-----------------+---------+---------------------+\n");
 }
@@ -278,13 +545,52 @@ void print_table_row(const char* algorithm, BSTCharacteristics chars) {
            algorithm, chars.size, chars.control_sum, chars.height, chars.weighted_height);
 }
 
-int main() {
+// Замер A1 и A2 на большом числе ключей в случайном порядке
+void run_scale_test(int n) {
+    int* keys = (int*)malloc((size_t)n * sizeof(int));
+    int* weights = (int*)malloc((size_t)n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        keys[i] = i + 1;
+        weights[i] = rand() % 100 + 1;
+    }
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)(((long long)rand() * RAND_MAX + rand()) % (i + 1));
+        swap(&keys[i], &keys[j]);
+    }
+    
+    printf("ЗАМЕР ПОСТРОЕНИЯ A1 И A2, n = %d\n", n);
+    
+    clock_t start = clock();
+    Node* a1_root = algorithm_a1(keys, weights, n);
+    double a1_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+    
+    start = clock();
+    Node* a2_root = algorithm_a2(keys, weights, n);
+    double a2_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+    
+    printf("A1: %.3f с\n", a1_time);
+    printf("A2: %.3f с\n", a2_time);
+    
+    free_tree(a1_root);
+    free_tree(a2_root);
+    free(keys);
+    free(weights);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        srand(42);
+        run_scale_test(atoi(argv[1]));
+        return 0;
+    }
+    
     const int n = 100;
     int keys[n];
     int weights[n];
     double total_weight = 0;
     
     srand(42);
+    optimal_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
     
     // Генерация ключей и весов
     for (int i = 0; i < n; i++) {
@@ -328,6 +634,12 @@ int main() {
     calculate_characteristics(a2_root, 1, &a2_chars);
     a2_chars.weighted_height /= aw_value;  // Делим на общую сумму весов
     
+    // Тестирование алгоритма Гарсиа-Уокса (веса только у листьев)
+    Node* gw_root = garsia_wachs(keys, weights, n);
+    BSTCharacteristics gw_chars = {0, 0, 0, 0.0};
+    calculate_leaf_characteristics(gw_root, 0, &gw_chars);
+    gw_chars.weighted_height /= aw_value;
+    
     // Вывод таблицы
     print_table_header();
     print_table_row("ДОП", optimal_chars);
@@ -335,6 +647,64 @@ int main() {
     print_table_row("A2", a2_chars);
     print_separator();
     
+    // Другая модель стоимости, поэтому отдельная таблица
+    printf("\nАЛФАВИТНОЕ ДЕРЕВО (веса только у листьев):\n");
+    print_table_header();
+    print_table_row("Гарсиа-Уокс", gw_chars);
+    print_separator();
+    printf("Ключи - листья, и поиск всегда доходит до листа: высота - число сравнений\n");
+    printf("до листа. В ДОП, A1 и A2 поиск останавливается на вершине с ключом, поэтому\n");
+    printf("средневзвешенные высоты двух таблиц сравнивать нельзя\n");
+    
+    // Время построения ДОП и Гарсиа-Уокса при росте n
+    printf("\nВРЕМЯ ПОСТРОЕНИЯ (с):\n");
+    printf("%-10s %-12s %-12s\n", "n", "ДОП", "Гарсиа-Уокс");
+    for (int size = 500; size <= 8000; size *= 2) {
+        int* big_keys = (int*)malloc(size * sizeof(int));
+        int* big_weights = (int*)malloc(size * sizeof(int));
+        for (int i = 0; i < size; i++) {
+            big_keys[i] = i + 1;
+            big_weights[i] = rand() % 100 + 1;
+        }
+        
+        double start = now_seconds();
+        Node* big_optimal = optimal_bst(big_keys, big_weights, size);
+        double optimal_time = now_seconds() - start;
+        
+        start = now_seconds();
+        Node* big_gw = garsia_wachs(big_keys, big_weights, size);
+        double gw_time = now_seconds() - start;
+        
+        printf("%-10d %-12.4f %-12.4f\n", size, optimal_time, gw_time);
+        free_tree(big_optimal);
+        free_tree(big_gw);
+        free(big_keys);
+        free(big_weights);
+    }
+    
+    // Половина поисков - промахи: веса лакун того же порядка, что и веса ключей
+    int gaps[n + 1];
+    double miss_weight = 0;
+    for (int i = 0; i <= n; i++) {
+        gaps[i] = rand() % 100 + 1;
+        miss_weight += gaps[i];
+    }
+    double gap_ap, gap_aw;
+    Node* gap_optimal_root = optimal_bst_with_gaps(keys, weights, gaps, n, &gap_ap, &gap_aw);
+    Node* gap_a2_root = algorithm_a2_with_gaps(keys, weights, gaps, n);
+    
+    printf("\nДЕРЕВЬЯ С ВЕСАМИ ПРОМАХОВ (сумма q = %.0f), ОЖИДАЕМОЕ ЧИСЛО СРАВНЕНИЙ:\n", miss_weight);
+    printf("+-----------------+-------------+-------------+-------------+\n");
+    printf("| %-15s | %-11s | %-11s | %-11s |\n", "Алгоритм", "Успешный", "Неуспешный", "Все поиски");
+    printf("+-----------------+-------------+-------------+-------------+\n");
+    print_gap_row("ДОП без q", optimal_root, gaps, total_weight, miss_weight);
+    print_gap_row("ДОП с q", gap_optimal_root, gaps, total_weight, miss_weight);
+    print_gap_row("A2 с q", gap_a2_root, gaps, total_weight, miss_weight);
+    printf("+-----------------+-------------+-------------+-------------+\n");
+    printf("AP[0,%d] / AW[0,%d] с промахами = %.6f\n", n, n, gap_ap / gap_aw);
+    free_tree(gap_optimal_root);
+    free_tree(gap_a2_root);
+    
     // Вывод обходов деревьев (только первых 10 элементов для читаемости)
     printf("\nОБХОДЫ ДЕРЕВЬЕВ СЛЕВА НАПРАВО:\n");
     printf("---------------------------------------------------\n");
@@ -365,6 +735,7 @@ int main() {
     free_tree(optimal_root);
     free_tree(a1_root);
     free_tree(a2_root);
+    free_tree(gw_root);
     free(traversal);
     
     return 0;
@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+
+#include "tree_common.h"
+
+// Гибридное построение дерева поиска для очень больших наборов ключей:
+// верхние уровни делятся по взвешенной медиане (как A2), а интервалы не длиннее
+// порога достраиваются точным алгоритмом Кнута (ДОП).
+// Сборка: gcc -O2 hybrid.c -o hybrid -lm
+// Запуск: ./hybrid [n] [порог точного ДОП]
+
+// До этого n дополнительно строится полное ДОП для сравнения
+#define FULL_OPTIMAL_LIMIT 10000
+
+typedef struct BSTCharacteristics {
+    int size;
+    long long control_sum;
+    int height;
+    double weighted_height;
+} BSTCharacteristics;
+
+// Характеристики без рекурсии: обход с явным стеком (вершина, глубина)
+void calculate_characteristics(Node* root, BSTCharacteristics* chars, int n) {
+    Node** nodes = (Node**)malloc(((size_t)n + 1) * sizeof(Node*));
+    int* depths = (int*)malloc(((size_t)n + 1) * sizeof(int));
+    int top = 0;
+    if (root != NULL) {
+        nodes[top] = root;
+        depths[top++] = 1;
+    }
+    while (top > 0) {
+        top--;
+        Node* p = nodes[top];
+        int depth = depths[top];
+        chars->size++;
+        chars->control_sum += p->key;
+        if (depth > chars->height) chars->height = depth;
+        chars->weighted_height += (double)p->weight * depth;
+        if (p->left) { nodes[top] = p->left; depths[top++] = depth + 1; }
+        if (p->right) { nodes[top] = p->right; depths[top++] = depth + 1; }
+    }
+    free(nodes);
+    free(depths);
+}
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void print_separator() {
+    printf("+----------------------+-----------+-----------------+---------+-----------------+------------+\n");
+}
+
+void print_row(const char* name, BSTCharacteristics c, long long total_weight, double seconds) {
+    printf("| %-20s | %-9d | %-15lld | %-7d | %-15.6f | %10.3f |\n",
+           name, c.size, c.control_sum, c.height, c.weighted_height / total_weight, seconds);
+}
+
+int main(int argc, char* argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 1000000;
+    int threshold = (argc > 2) ? atoi(argv[2]) : DEFAULT_EXACT_THRESHOLD;
+    if (n < 1 || threshold < 1) {
+        printf("Использование: %s [n] [порог точного ДОП]\n", argv[0]);
+        return 1;
+    }
+
+    int* keys = (int*)malloc((size_t)n * sizeof(int));
+    int* weights = (int*)malloc((size_t)n * sizeof(int));
+    long long total_weight = 0;
+    srand(42);
+    for (int i = 0; i < n; i++) {
+        keys[i] = i + 1;
+        weights[i] = rand() % 100 + 1;
+        total_weight += weights[i];
+    }
+
+    printf("ГИБРИДНОЕ ПОСТРОЕНИЕ: A2 СВЕРХУ, ДОП НА ИНТЕРВАЛАХ ДО %d КЛЮЧЕЙ\n", threshold);
+    printf("Количество вершин: %d\n", n);
+    printf("Сумма всех весов: %lld\n\n", total_weight);
+
+    print_separator();
+    printf("| %-20s | %-9s | %-15s | %-7s | %-15s | %-10s |\n",
+           "Алгоритм", "Размер", "Контр.Сумма", "Высота", "Ср.взв.высота", "Время, с");
+    print_separator();
+
+    NodePool pool;
+    pool.nodes = (Node*)malloc((size_t)n * sizeof(Node));
+
+    // Порог 1 превращает гибрид в чистое деление по медиане (A2)
+    pool.used = 0;
+    double start = now_seconds();
+    Node* a2_root = hybrid_build(keys, weights, n, 1, &pool);
+    double a2_time = now_seconds() - start;
+    BSTCharacteristics a2_chars = {0, 0, 0, 0.0};
+    calculate_characteristics(a2_root, &a2_chars, n);
+    print_row("A2", a2_chars, total_weight, a2_time);
+
+    pool.used = 0;
+    start = now_seconds();
+    Node* hybrid_root = hybrid_build(keys, weights, n, threshold, &pool);
+    double hybrid_time = now_seconds() - start;
+    BSTCharacteristics hybrid_chars = {0, 0, 0, 0.0};
+    calculate_characteristics(hybrid_root, &hybrid_chars, n);
+    print_row("Гибрид A2+ДОП", hybrid_chars, total_weight, hybrid_time);
+
+    if (n <= FULL_OPTIMAL_LIMIT) {
+        pool.used = 0;
+        ExactScratch scratch;
+        start = now_seconds();
+        if (exact_scratch_init(&scratch, n)) {
+            Node* optimal_root;
+            long long ap = exact_optimal(&scratch, keys, weights, n, &pool, &optimal_root);
+            double optimal_time = now_seconds() - start;
+            BSTCharacteristics optimal_chars = {0, 0, 0, 0.0};
+            calculate_characteristics(optimal_root, &optimal_chars, n);
+            print_row("ДОП", optimal_chars, total_weight, optimal_time);
+            print_separator();
+            printf("Гибрид хуже оптимума на %.4f%% (AP[0,n]/AW[0,n] = %.6f)\n",
+                   (hybrid_chars.weighted_height / ap - 1) * 100, (double)ap / total_weight);
+        } else {
+            print_separator();
+            printf("Недостаточно памяти для полного ДОП\n");
+        }
+        exact_scratch_free(&scratch);
+    } else {
+        print_separator();
+        printf("Полное ДОП не строится: n > %d\n", FULL_OPTIMAL_LIMIT);
+    }
+
+    free(pool.nodes);
+    free(keys);
+    free(weights);
+    return 0;
+}
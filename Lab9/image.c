@@ -0,0 +1,434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "tree_common.h"
+
+// Образ построенного дерева на диске: заголовок со статистикой и контрольной суммой
+// и плоский массив вершин в прямом порядке обхода, где потомки заданы смещением
+// относительно самой вершины. Файл открывается через mmap, и поиск идет прямо
+// по отображенной памяти - без разбора, копирования и malloc.
+// Сборка: gcc -O2 image.c -o image
+// Запуск: ./image save <файл> <dop|avl|dbd|isdp> [n]
+//         ./image load <файл> [поисков]
+//         ./image find <файл> <ключ>...
+
+typedef struct TreeImage {
+    void* map;
+    size_t map_size;
+    const ImageHeader* header;
+    const ImageNode* nodes;
+} TreeImage;
+
+// ---------------- Построение деревьев (как в Lab3, Lab7, Lab9) ----------------
+
+Node* build_isdp(int L, int R, int* keys, int* weights) {
+    if (L > R) return NULL;
+    int m = (L + R + 1) / 2;
+    Node* p = create_node(keys[m], weights[m]);
+    p->left = build_isdp(L, m - 1, keys, weights);
+    p->right = build_isdp(m + 1, R, keys, weights);
+    return p;
+}
+
+void LL_rotate(Node** p) {
+    Node* q = (*p)->left;
+    (*p)->bal = 0;
+    q->bal = 0;
+    (*p)->left = q->right;
+    q->right = *p;
+    *p = q;
+}
+
+void RR_rotate(Node** p) {
+    Node* q = (*p)->right;
+    (*p)->bal = 0;
+    q->bal = 0;
+    (*p)->right = q->left;
+    q->left = *p;
+    *p = q;
+}
+
+void LR_rotate(Node** p) {
+    Node* q = (*p)->left;
+    Node* r = q->right;
+    (*p)->bal = (r->bal < 0) ? 1 : 0;
+    q->bal = (r->bal > 0) ? -1 : 0;
+    r->bal = 0;
+    q->right = r->left;
+    (*p)->left = r->right;
+    r->left = q;
+    r->right = *p;
+    *p = r;
+}
+
+void RL_rotate(Node** p) {
+    Node* q = (*p)->right;
+    Node* r = q->left;
+    (*p)->bal = (r->bal > 0) ? -1 : 0;
+    q->bal = (r->bal < 0) ? 1 : 0;
+    r->bal = 0;
+    q->left = r->right;
+    (*p)->right = r->left;
+    r->right = q;
+    r->left = *p;
+    *p = r;
+}
+
+void insert_avl(int key, int weight, Node** p, int* rost) {
+    if (*p == NULL) {
+        *p = create_node(key, weight);
+        *rost = 1;
+    } else if ((*p)->key > key) {
+        insert_avl(key, weight, &(*p)->left, rost);
+        if (*rost) {
+            if ((*p)->bal > 0) {
+                (*p)->bal = 0;
+                *rost = 0;
+            } else if ((*p)->bal == 0) {
+                (*p)->bal = -1;
+            } else {
+                if ((*p)->left->bal < 0) LL_rotate(p);
+                else LR_rotate(p);
+                *rost = 0;
+            }
+        }
+    } else if ((*p)->key < key) {
+        insert_avl(key, weight, &(*p)->right, rost);
+        if (*rost) {
+            if ((*p)->bal < 0) {
+                (*p)->bal = 0;
+                *rost = 0;
+            } else if ((*p)->bal == 0) {
+                (*p)->bal = 1;
+            } else {
+                if ((*p)->right->bal > 0) RR_rotate(p);
+                else RL_rotate(p);
+                *rost = 0;
+            }
+        }
+    } else {
+        *rost = 0;
+    }
+}
+
+// Двоичное Б-дерево: bal = 1 означает горизонтальную правую связь
+void insert_dbd(int key, int weight, Node** p, int* VR, int* HR) {
+    if (*p == NULL) {
+        *p = create_node(key, weight);
+        *VR = 1;
+    } else if ((*p)->key > key) {
+        insert_dbd(key, weight, &(*p)->left, VR, HR);
+        if (*VR == 1) {
+            if ((*p)->bal == 0) {
+                Node* q = (*p)->left;
+                (*p)->left = q->right;
+                q->right = *p;
+                *p = q;
+                (*p)->bal = 1;
+                *VR = 0;
+                *HR = 1;
+            } else {
+                (*p)->bal = 0;
+                *VR = 1;
+                *HR = 0;
+            }
+        } else {
+            *HR = 0;
+        }
+    } else if ((*p)->key < key) {
+        insert_dbd(key, weight, &(*p)->right, VR, HR);
+        if (*VR == 1) {
+            (*p)->bal = 1;
+            *HR = 1;
+            *VR = 0;
+        } else if (*HR == 1) {
+            if ((*p)->bal == 1) {
+                Node* q = (*p)->right;
+                (*p)->bal = 0;
+                q->bal = 0;
+                (*p)->right = q->left;
+                q->left = *p;
+                *p = q;
+                *VR = 1;
+                *HR = 0;
+            } else {
+                *HR = 0;
+            }
+        }
+    }
+}
+
+// ---------------- Загрузка и поиск на месте ----------------
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Отображает файл и проверяет заголовок, размер, контрольную сумму и то, что все
+// смещения остаются внутри массива. Память не выделяется
+int open_image(const char* path, TreeImage* image) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Ошибка: не удалось открыть %s\n", path);
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ImageHeader)) {
+        printf("Ошибка: %s слишком мал для образа дерева\n", path);
+        close(fd);
+        return 0;
+    }
+    image->map_size = (size_t)st.st_size;
+    image->map = mmap(NULL, image->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (image->map == MAP_FAILED) {
+        printf("Ошибка: mmap %s не удался\n", path);
+        return 0;
+    }
+
+    image->header = (const ImageHeader*)image->map;
+    image->nodes = (const ImageNode*)((const char*)image->map + sizeof(ImageHeader));
+    const ImageHeader* h = image->header;
+    const char* error = NULL;
+    if (memcmp(h->magic, IMAGE_MAGIC, sizeof(h->magic)) != 0) {
+        error = "не образ дерева";
+    } else if (h->version != IMAGE_VERSION || h->byte_order != IMAGE_BYTE_ORDER) {
+        error = "другая версия формата или порядок байт";
+    } else if (h->kind < KIND_DOP || h->kind > KIND_HYBRID ||
+               image->map_size != sizeof(ImageHeader) + (size_t)h->node_count * sizeof(ImageNode)) {
+        error = "размер файла не совпадает с заголовком";
+    } else if (image_checksum(image->nodes, (size_t)h->node_count * sizeof(ImageNode)) != h->checksum) {
+        error = "контрольная сумма не совпадает";
+    } else {
+        for (uint32_t i = 0; i < h->node_count; i++) {
+            int64_t left = (int64_t)i + image->nodes[i].left;
+            int64_t right = (int64_t)i + image->nodes[i].right;
+            if (image->nodes[i].left < 0 || image->nodes[i].right < 0 ||
+                left >= h->node_count || right >= h->node_count) {
+                error = "смещение потомка вне массива";
+                break;
+            }
+        }
+    }
+    if (error != NULL) {
+        printf("Ошибка: %s: %s\n", path, error);
+        munmap(image->map, image->map_size);
+        return 0;
+    }
+    return 1;
+}
+
+void close_image(TreeImage* image) {
+    munmap(image->map, image->map_size);
+}
+
+// Возвращает вершину с ключом или NULL
+const ImageNode* image_search(const TreeImage* image, int key) {
+    if (image->header->node_count == 0) return NULL;
+    const ImageNode* p = image->nodes;
+    for (;;) {
+        if (key < p->key) {
+            if (p->left == 0) return NULL;
+            p += p->left;
+        } else if (key > p->key) {
+            if (p->right == 0) return NULL;
+            p += p->right;
+        } else {
+            return p;
+        }
+    }
+}
+
+void print_image_info(const TreeImage* image) {
+    const ImageHeader* h = image->header;
+    printf("Дерево: %s, вершин: %u, высота: %u\n", kind_names[h->kind], h->node_count, h->height);
+    printf("Контрольная сумма ключей: %lld, сумма весов: %lld\n",
+           (long long)h->control_sum, (long long)h->total_weight);
+    if (h->total_weight > 0) {
+        printf("Средневзвешенная высота: %.6f\n", (double)h->weighted_height / h->total_weight);
+    }
+}
+
+// ---------------- Режимы ----------------
+
+// Уникальные случайные ключи в случайном порядке (для АВЛ и ДБД) и их веса
+void generate_keys(int* keys, int* weights, int n) {
+    for (int i = 0; i < n; i++) {
+        keys[i] = 2 * i + 1;
+        weights[i] = rand() % 100 + 1;
+    }
+    for (int i = n - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        int t = keys[i];
+        keys[i] = keys[j];
+        keys[j] = t;
+    }
+}
+
+int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+int run_save(const char* path, const char* kind_name, int n) {
+    int kind = 0;
+    if (strcmp(kind_name, "dop") == 0) kind = KIND_DOP;
+    else if (strcmp(kind_name, "avl") == 0) kind = KIND_AVL;
+    else if (strcmp(kind_name, "dbd") == 0) kind = KIND_DBD;
+    else if (strcmp(kind_name, "isdp") == 0) kind = KIND_ISDP;
+    else {
+        printf("Неизвестный тип дерева: %s (dop, avl, dbd, isdp)\n", kind_name);
+        return 1;
+    }
+
+    int* keys = (int*)malloc((size_t)n * sizeof(int));
+    int* weights = (int*)malloc((size_t)n * sizeof(int));
+    srand(42);
+    generate_keys(keys, weights, n);
+
+    double start = now_seconds();
+    Node* root = NULL;
+    // ДОП строится в пуле вершин из tree_common.h, остальные деревья - через malloc
+    NodePool pool = {NULL, 0};
+    if (kind == KIND_AVL) {
+        for (int i = 0; i < n; i++) {
+            int rost = 0;
+            insert_avl(keys[i], weights[i], &root, &rost);
+        }
+    } else if (kind == KIND_DBD) {
+        for (int i = 0; i < n; i++) {
+            int VR = 1, HR = 1;
+            insert_dbd(keys[i], weights[i], &root, &VR, &HR);
+        }
+    } else {
+        // ИСДП и ДОП строятся по упорядоченным ключам; вес остается у своего ключа
+        int* order = (int*)malloc((size_t)n * 2 * sizeof(int));
+        for (int i = 0; i < n; i++) {
+            order[2 * i] = keys[i];
+            order[2 * i + 1] = weights[i];
+        }
+        qsort(order, n, 2 * sizeof(int), compare_ints);
+        for (int i = 0; i < n; i++) {
+            keys[i] = order[2 * i];
+            weights[i] = order[2 * i + 1];
+        }
+        free(order);
+        if (kind == KIND_ISDP) {
+            root = build_isdp(0, n - 1, keys, weights);
+        } else {
+            ExactScratch scratch;
+            pool.nodes = (Node*)malloc((size_t)n * sizeof(Node));
+            if (pool.nodes && exact_scratch_init(&scratch, n)) {
+                exact_optimal(&scratch, keys, weights, n, &pool, &root);
+            } else {
+                printf("Ошибка: недостаточно памяти для матриц ДОП (n=%d)\n", n);
+            }
+            if (pool.nodes) exact_scratch_free(&scratch);
+        }
+    }
+    double build_time = now_seconds() - start;
+    if (root == NULL) {
+        free(pool.nodes);
+        free(keys);
+        free(weights);
+        return 1;
+    }
+
+    start = now_seconds();
+    ImageHeader header;
+    int ok = save_image(path, root, n, kind, &header);
+    double save_time = now_seconds() - start;
+    if (pool.nodes == NULL) free_tree(root);
+    free(pool.nodes);
+    free(keys);
+    free(weights);
+    if (!ok) return 1;
+
+    printf("Построение %s (n=%d): %.3f с, запись образа: %.3f с\n", kind_names[kind], n, build_time, save_time);
+    printf("Файл %s: %zu байт\n", path, sizeof(ImageHeader) + (size_t)n * sizeof(ImageNode));
+    return 0;
+}
+
+int run_load(const char* path, int lookups) {
+    double start = now_seconds();
+    TreeImage image;
+    if (!open_image(path, &image)) return 1;
+    double load_time = now_seconds() - start;
+
+    print_image_info(&image);
+    printf("Загрузка (mmap + проверка): %.3f мс\n", load_time * 1000);
+
+    // Ключи для поиска берутся из самого образа, нечетные соседи дают промахи
+    uint32_t count = image.header->node_count;
+    int* queries = (int*)malloc((size_t)lookups * sizeof(int));
+    srand(time(NULL));
+    for (int i = 0; i < lookups; i++) {
+        int key = count ? image.nodes[rand() % count].key : 0;
+        queries[i] = (i % 2 == 0) ? key : key + 1;
+    }
+
+    int found = 0;
+    start = now_seconds();
+    for (int i = 0; i < lookups; i++) {
+        if (image_search(&image, queries[i]) != NULL) found++;
+    }
+    double search_time = now_seconds() - start;
+    printf("Поисков: %d, найдено: %d, %.1f нс на поиск\n", lookups, found, search_time * 1e9 / lookups);
+
+    free(queries);
+    close_image(&image);
+    return 0;
+}
+
+int run_find(const char* path, int argc, char* argv[]) {
+    TreeImage image;
+    if (!open_image(path, &image)) return 1;
+    for (int i = 0; i < argc; i++) {
+        int key = atoi(argv[i]);
+        const ImageNode* p = image_search(&image, key);
+        if (p != NULL) printf("%d: найден, вес %d\n", key, p->weight);
+        else printf("%d: не найден\n", key);
+    }
+    close_image(&image);
+    return 0;
+}
+
+void print_usage(const char* program) {
+    printf("Использование:\n");
+    printf("  %s save <файл> <dop|avl|dbd|isdp> [n]\n", program);
+    printf("  %s load <файл> [поисков]\n", program);
+    printf("  %s find <файл> <ключ>...\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 4 && strcmp(argv[1], "save") == 0) {
+        int n = (argc > 4) ? atoi(argv[4]) : 5000;
+        if (n < 1) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return run_save(argv[2], argv[3], n);
+    }
+    if (argc >= 3 && strcmp(argv[1], "load") == 0) {
+        int lookups = (argc > 3) ? atoi(argv[3]) : 1000000;
+        if (lookups < 1) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return run_load(argv[2], lookups);
+    }
+    if (argc >= 4 && strcmp(argv[1], "find") == 0) {
+        return run_find(argv[2], argc - 3, argv + 3);
+    }
+    print_usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,395 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "tree_common.h"
+
+// Построение дерева поиска по реальной нагрузке: журналы обращений читаются через
+// mmap, разбираются параллельно порциями, частоты ключей считаются в хеш-таблицах
+// потоков, затем по частотам строится ДОП, A2 или гибрид A2+ДОП (tree_common.h)
+// и записывается образ дерева в формате image.c.
+// Журнал - текст, в каждой строке ключ обращения (целое число) в поле с номером
+// field; поля разделяются пробелами, табуляцией, запятыми или точкой с запятой.
+// Сборка: gcc -O2 -pthread ingest.c -o ingest
+// Запуск: ./ingest [-t потоков] [-b dop|a2|hybrid] [-f поле] -o образ журнал...
+
+#define CHUNK_SIZE (16 << 20)
+#define INITIAL_TABLE_BITS 16
+// Полное ДОП требует O(n^2) памяти, дальше только гибрид
+#define FULL_OPTIMAL_LIMIT 20000
+
+// ---------------- Подсчет частот ----------------
+
+// Открытая адресация, count == 0 - свободная ячейка
+typedef struct FreqEntry {
+    int key;
+    long long count;
+} FreqEntry;
+
+typedef struct FreqTable {
+    FreqEntry* entries;
+    size_t mask;
+    size_t used;
+} FreqTable;
+
+// Отображенный файл журнала
+typedef struct LogFile {
+    const char* path;
+    const char* data;
+    size_t size;
+} LogFile;
+
+// Порция: строки, начинающиеся в [begin, end) файла file
+typedef struct Chunk {
+    int file;
+    size_t begin;
+    size_t end;
+} Chunk;
+
+typedef struct IngestContext {
+    LogFile* files;
+    Chunk* chunks;
+    int chunk_count;
+    atomic_int next_chunk;
+    int field;
+    FreqTable* tables;
+    long long* lines;
+    long long* skipped;
+} IngestContext;
+
+typedef struct WorkerArg {
+    IngestContext* ctx;
+    int id;
+} WorkerArg;
+
+static inline size_t hash_key(int key) {
+    return (size_t)(((uint64_t)(uint32_t)key * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+void table_init(FreqTable* t, int bits) {
+    t->mask = ((size_t)1 << bits) - 1;
+    t->used = 0;
+    t->entries = (FreqEntry*)calloc(t->mask + 1, sizeof(FreqEntry));
+}
+
+void table_add(FreqTable* t, int key, long long count);
+
+// Таблица удваивается при заполнении наполовину
+void table_grow(FreqTable* t) {
+    FreqEntry* old = t->entries;
+    size_t old_size = t->mask + 1;
+    t->mask = old_size * 2 - 1;
+    t->used = 0;
+    t->entries = (FreqEntry*)calloc(t->mask + 1, sizeof(FreqEntry));
+    for (size_t i = 0; i < old_size; i++) {
+        if (old[i].count != 0) table_add(t, old[i].key, old[i].count);
+    }
+    free(old);
+}
+
+void table_add(FreqTable* t, int key, long long count) {
+    size_t i = hash_key(key) & t->mask;
+    while (t->entries[i].count != 0) {
+        if (t->entries[i].key == key) {
+            t->entries[i].count += count;
+            return;
+        }
+        i = (i + 1) & t->mask;
+    }
+    t->entries[i].key = key;
+    t->entries[i].count = count;
+    if (++t->used * 2 > t->mask + 1) table_grow(t);
+}
+
+static inline int is_separator(char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r';
+}
+
+// Разбор строк порции. Строка принадлежит порции, в которой она начинается,
+// поэтому начало сдвигается к следующей строке, а конец может выйти за end
+void parse_chunk(IngestContext* ctx, int id, Chunk* chunk) {
+    const char* data = ctx->files[chunk->file].data;
+    const char* limit = data + ctx->files[chunk->file].size;
+    const char* p = data + chunk->begin;
+    const char* end = data + chunk->end;
+    FreqTable* table = &ctx->tables[id];
+    long long lines = 0, skipped = 0;
+
+    if (chunk->begin > 0 && p[-1] != '\n') {
+        const char* nl = (const char*)memchr(p, '\n', limit - p);
+        p = nl ? nl + 1 : limit;
+    }
+
+    while (p < end) {
+        const char* nl = (const char*)memchr(p, '\n', limit - p);
+        const char* line_end = nl ? nl : limit;
+        lines++;
+
+        // Пропускаем поля до нужного
+        const char* q = p;
+        for (int f = 1;; f++) {
+            while (q < line_end && is_separator(*q)) q++;
+            if (f == ctx->field || q >= line_end) break;
+            while (q < line_end && !is_separator(*q)) q++;
+        }
+
+        int negative = 0;
+        if (q < line_end && *q == '-') {
+            negative = 1;
+            q++;
+        }
+        long long value = 0;
+        int digits = 0;
+        while (q < line_end && *q >= '0' && *q <= '9' && digits < 11) {
+            value = value * 10 + (*q - '0');
+            q++;
+            digits++;
+        }
+        if (negative) value = -value;
+        if (digits == 0 || (q < line_end && !is_separator(*q)) || value < INT32_MIN || value > INT32_MAX) {
+            skipped++;
+        } else {
+            table_add(table, (int)value, 1);
+        }
+        p = line_end + 1;
+    }
+
+    ctx->lines[id] += lines;
+    ctx->skipped[id] += skipped;
+}
+
+void* ingest_worker(void* arg) {
+    WorkerArg* w = (WorkerArg*)arg;
+    IngestContext* ctx = w->ctx;
+    for (;;) {
+        int c = atomic_fetch_add_explicit(&ctx->next_chunk, 1, memory_order_relaxed);
+        if (c >= ctx->chunk_count) break;
+        parse_chunk(ctx, w->id, &ctx->chunks[c]);
+    }
+    return NULL;
+}
+
+// ---------------- Сортировка частот по ключу ----------------
+
+// Поразрядная сортировка по 16 бит за проход; order_key - из tree_common.h
+void radix_sort_entries(FreqEntry* entries, size_t n) {
+    FreqEntry* buffer = (FreqEntry*)malloc(n * sizeof(FreqEntry));
+    size_t* count = (size_t*)malloc(((size_t)1 << 16) * sizeof(size_t));
+    FreqEntry* from = entries;
+    FreqEntry* to = buffer;
+    for (int shift = 0; shift < 32; shift += 16) {
+        memset(count, 0, ((size_t)1 << 16) * sizeof(size_t));
+        for (size_t i = 0; i < n; i++) count[(order_key(from[i].key) >> shift) & 0xFFFF]++;
+        size_t sum = 0;
+        for (size_t d = 0; d < ((size_t)1 << 16); d++) {
+            size_t c = count[d];
+            count[d] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < n; i++) to[count[(order_key(from[i].key) >> shift) & 0xFFFF]++] = from[i];
+        FreqEntry* t = from;
+        from = to;
+        to = t;
+    }
+    // После двух проходов результат снова в entries
+    free(buffer);
+    free(count);
+}
+
+// ---------------- main ----------------
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void print_usage(const char* program) {
+    printf("Использование: %s [-t потоков] [-b dop|a2|hybrid] [-f поле] -o образ журнал...\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int field = 1;
+    int kind = KIND_HYBRID;
+    const char* output = NULL;
+    int first_file = argc;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            field = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "dop") == 0) kind = KIND_DOP;
+            else if (strcmp(argv[i], "a2") == 0) kind = KIND_A2;
+            else if (strcmp(argv[i], "hybrid") == 0) kind = KIND_HYBRID;
+            else kind = 0;
+        } else {
+            first_file = i;
+            break;
+        }
+    }
+    if (output == NULL || first_file >= argc || threads < 1 || field < 1 || kind == 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Отображаем журналы и режем их на порции
+    int file_count = argc - first_file;
+    LogFile* files = (LogFile*)calloc(file_count, sizeof(LogFile));
+    size_t total_bytes = 0;
+    int chunk_count = 0;
+    for (int f = 0; f < file_count; f++) {
+        files[f].path = argv[first_file + f];
+        int fd = open(files[f].path, O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            printf("Ошибка: не удалось открыть %s\n", files[f].path);
+            return 1;
+        }
+        files[f].size = (size_t)st.st_size;
+        if (files[f].size > 0) {
+            void* map = mmap(NULL, files[f].size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED) {
+                printf("Ошибка: mmap %s не удался\n", files[f].path);
+                return 1;
+            }
+            madvise(map, files[f].size, MADV_SEQUENTIAL);
+            files[f].data = (const char*)map;
+        }
+        close(fd);
+        total_bytes += files[f].size;
+        chunk_count += (int)((files[f].size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    }
+
+    IngestContext ctx;
+    ctx.files = files;
+    ctx.field = field;
+    ctx.chunk_count = chunk_count;
+    ctx.chunks = (Chunk*)malloc((size_t)(chunk_count > 0 ? chunk_count : 1) * sizeof(Chunk));
+    atomic_init(&ctx.next_chunk, 0);
+    int c = 0;
+    for (int f = 0; f < file_count; f++) {
+        for (size_t begin = 0; begin < files[f].size; begin += CHUNK_SIZE) {
+            size_t end = begin + CHUNK_SIZE < files[f].size ? begin + CHUNK_SIZE : files[f].size;
+            ctx.chunks[c++] = (Chunk){f, begin, end};
+        }
+    }
+    ctx.tables = (FreqTable*)malloc(threads * sizeof(FreqTable));
+    ctx.lines = (long long*)calloc(threads, sizeof(long long));
+    ctx.skipped = (long long*)calloc(threads, sizeof(long long));
+    for (int t = 0; t < threads; t++) table_init(&ctx.tables[t], INITIAL_TABLE_BITS);
+
+    printf("Журналов: %d, объем: %.1f МБ, порций: %d, потоков: %d\n",
+           file_count, total_bytes / 1048576.0, chunk_count, threads);
+
+    double start = now_seconds();
+    pthread_t* workers = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    WorkerArg* args = (WorkerArg*)malloc(threads * sizeof(WorkerArg));
+    for (int t = 0; t < threads; t++) {
+        args[t] = (WorkerArg){&ctx, t};
+        if (t > 0) pthread_create(&workers[t], NULL, ingest_worker, &args[t]);
+    }
+    ingest_worker(&args[0]);
+    for (int t = 1; t < threads; t++) pthread_join(workers[t], NULL);
+
+    // Слияние таблиц потоков в первую
+    FreqTable* freq = &ctx.tables[0];
+    long long lines = ctx.lines[0], skipped = ctx.skipped[0];
+    for (int t = 1; t < threads; t++) {
+        FreqTable* other = &ctx.tables[t];
+        for (size_t i = 0; i <= other->mask; i++) {
+            if (other->entries[i].count != 0) table_add(freq, other->entries[i].key, other->entries[i].count);
+        }
+        free(other->entries);
+        lines += ctx.lines[t];
+        skipped += ctx.skipped[t];
+    }
+    double parse_time = now_seconds() - start;
+
+    for (int f = 0; f < file_count; f++) {
+        if (files[f].size > 0) munmap((void*)files[f].data, files[f].size);
+    }
+
+    printf("Разбор: %.3f с (%.1f МБ/с), строк: %lld, пропущено: %lld, различных ключей: %zu\n",
+           parse_time, parse_time > 0 ? total_bytes / 1048576.0 / parse_time : 0.0,
+           lines, skipped, freq->used);
+    if (freq->used == 0) {
+        printf("Ошибка: в журналах не найдено ни одного ключа\n");
+        return 1;
+    }
+
+    // Сжимаем таблицу в массив и упорядочиваем по ключу
+    start = now_seconds();
+    size_t n = 0;
+    for (size_t i = 0; i <= freq->mask; i++) {
+        if (freq->entries[i].count != 0) freq->entries[n++] = freq->entries[i];
+    }
+    radix_sort_entries(freq->entries, n);
+
+    // Вес в образе 32-битный: при очень больших частотах все веса делятся на общий
+    // множитель, чтобы сохранить их соотношение
+    long long max_count = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (freq->entries[i].count > max_count) max_count = freq->entries[i].count;
+    }
+    long long divisor = max_count / INT32_MAX + 1;
+    int* keys = (int*)malloc(n * sizeof(int));
+    int* weights = (int*)malloc(n * sizeof(int));
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = freq->entries[i].key;
+        long long w = freq->entries[i].count / divisor;
+        weights[i] = w > 0 ? (int)w : 1;
+    }
+    free(freq->entries);
+    if (divisor > 1) printf("Частоты уменьшены в %lld раз для 32-битных весов\n", divisor);
+
+    if (kind == KIND_DOP && n > FULL_OPTIMAL_LIMIT) {
+        printf("Ключей больше %d: полное ДОП заменено гибридом A2+ДОП\n", FULL_OPTIMAL_LIMIT);
+        kind = KIND_HYBRID;
+    }
+    int threshold = (kind == KIND_DOP) ? (int)n : (kind == KIND_A2) ? 1 : DEFAULT_EXACT_THRESHOLD;
+
+    NodePool pool;
+    pool.nodes = (Node*)malloc(n * sizeof(Node));
+    pool.used = 0;
+    Node* root = hybrid_build(keys, weights, (int)n, threshold, &pool);
+    double build_time = now_seconds() - start;
+    if (root == NULL) return 1;
+
+    start = now_seconds();
+    ImageHeader header;
+    int ok = save_image(output, root, (int)n, kind, &header);
+    double save_time = now_seconds() - start;
+
+    if (ok) {
+        printf("Дерево: %s, вершин: %u, высота: %u, средневзвешенная высота: %.4f\n",
+               kind_names[kind], header.node_count, header.height,
+               (double)header.weighted_height / header.total_weight);
+        printf("Построение: %.3f с, запись %s: %.3f с\n", build_time, output, save_time);
+    }
+
+    free(pool.nodes);
+    free(keys);
+    free(weights);
+    free(ctx.chunks);
+    free(ctx.tables);
+    free(ctx.lines);
+    free(ctx.skipped);
+    free(workers);
+    free(args);
+    free(files);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,395 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Оптимальное сильноветвящееся дерево поиска: в вершине до B ключей, вершина занимает
+// одну строку кэша (64 байта), и стоимость поиска - число посещенных вершин.
+// Динамика обобщает алгоритм Кнута: C[i][j] = AW[i][j] + min по t <= B из P[t][i][j],
+// где P[t][i][j] - наименьшая сумма C по t+1 кускам интервала (i, j] после выбора
+// t ключей вершины. P[t][i][j] = min по r из C[i][r-1] + P[t-1][r][j], P[0] = C.
+// Время O(n^3 B), память O(n^2 B), поэтому n небольшое.
+// Сборка: gcc -O2 multiway.c -o multiway
+// Запуск: ./multiway [n] [длина трассы]
+
+// 14 ключей, индекс первого ребенка, маска детей и число ключей - ровно 64 байта
+#define MULTI_MAX_KEYS 14
+#define MULTI_INF (LLONG_MAX / 4)
+
+typedef struct MultiNode {
+    int32_t keys[MULTI_MAX_KEYS];
+    int32_t first_child;
+    uint16_t child_mask;
+    uint16_t count;
+} MultiNode;
+
+// Вершина двоичного ДОП в массиве прямого порядка, как в trace_bench.c
+typedef struct FlatNode {
+    int key;
+    int left;
+    int right;
+    int pad;
+} FlatNode;
+
+// Результат динамики: упакованные треугольники, P и выбор ключей - по столбцам
+typedef struct MultiwayPlan {
+    int n;
+    int max_keys;
+    long long* C;
+    unsigned char* best_t;
+    int* first[MULTI_MAX_KEYS + 1];
+} MultiwayPlan;
+
+static inline size_t tri_index(int n, int i, int j) {
+    return (size_t)i * (2 * (size_t)n + 3 - i) / 2 + (j - i);
+}
+
+// Столбец j: элементы (0, j), (1, j), ..., (j, j) подряд
+static inline size_t col_index(int i, int j) {
+    return (size_t)j * (j + 1) / 2 + i;
+}
+
+// ---------------- Двоичное ДОП (алгоритм Кнута) ----------------
+
+long long optimal_binary(int* weights, long long* prefix, int n, int** out_AR) {
+    size_t cells = ((size_t)n + 1) * ((size_t)n + 2) / 2;
+    long long* AP = (long long*)malloc(cells * sizeof(long long));
+    int* AR = (int*)malloc(cells * sizeof(int));
+    for (int i = 0; i <= n; i++) {
+        AP[tri_index(n, i, i)] = 0;
+        AR[tri_index(n, i, i)] = 0;
+    }
+    for (int i = 0; i < n; i++) {
+        AP[tri_index(n, i, i + 1)] = weights[i];
+        AR[tri_index(n, i, i + 1)] = i + 1;
+    }
+    for (int h = 2; h <= n; h++) {
+        for (int i = 0; i <= n - h; i++) {
+            int j = i + h;
+            long long* row_i = AP + tri_index(n, i, i) - i;
+            int m = AR[tri_index(n, i, j - 1)];
+            long long min_val = row_i[m - 1] + AP[tri_index(n, m, j)];
+            int max_k = AR[tri_index(n, i + 1, j)];
+            for (int k = m + 1; k <= max_k; k++) {
+                long long x = row_i[k - 1] + AP[tri_index(n, k, j)];
+                if (x < min_val) {
+                    m = k;
+                    min_val = x;
+                }
+            }
+            AP[tri_index(n, i, j)] = min_val + (prefix[j] - prefix[i]);
+            AR[tri_index(n, i, j)] = m;
+        }
+    }
+    long long cost = AP[tri_index(n, 0, n)];
+    free(AP);
+    *out_AR = AR;
+    return cost;
+}
+
+// Прямой порядок обхода по матрице AR
+int freeze_binary(int* AR, int* keys, int n, int L, int R, FlatNode* flat, int* next) {
+    if (L >= R) return -1;
+    int k = AR[tri_index(n, L, R)];
+    int index = (*next)++;
+    flat[index].key = keys[k - 1];
+    flat[index].left = freeze_binary(AR, keys, n, L, k - 1, flat, next);
+    flat[index].right = freeze_binary(AR, keys, n, k, R, flat, next);
+    return index;
+}
+
+// ---------------- Динамика для вершин из B ключей ----------------
+
+int multiway_plan(MultiwayPlan* plan, long long* prefix, int n, int max_keys) {
+    size_t cells = ((size_t)n + 1) * ((size_t)n + 2) / 2;
+    plan->n = n;
+    plan->max_keys = max_keys;
+    plan->C = (long long*)malloc(cells * sizeof(long long));
+    plan->best_t = (unsigned char*)malloc(cells);
+    // P[0] - копия C по столбцам, чтобы внутренний цикл читал оба слагаемых подряд
+    long long* P[MULTI_MAX_KEYS + 1];
+    int ok = plan->C && plan->best_t;
+    for (int t = 0; t <= max_keys; t++) {
+        P[t] = (long long*)malloc(cells * sizeof(long long));
+        plan->first[t] = (t > 0) ? (int*)malloc(cells * sizeof(int)) : NULL;
+        ok = ok && P[t] && (t == 0 || plan->first[t]);
+    }
+    if (!ok) {
+        printf("Ошибка: недостаточно памяти для динамики n=%d, B=%d\n", n, max_keys);
+        for (int t = 0; t <= max_keys; t++) free(P[t]);
+        return 0;
+    }
+
+    long long* C = plan->C;
+    for (int i = 0; i <= n; i++) {
+        C[tri_index(n, i, i)] = 0;
+        P[0][col_index(i, i)] = 0;
+    }
+
+    for (int h = 1; h <= n; h++) {
+        for (int i = 0; i <= n - h; i++) {
+            int j = i + h;
+            const long long* row_i = C + tri_index(n, i, i) - i;
+            long long best = MULTI_INF;
+            int best_t = 1;
+            int t_limit = (h < max_keys) ? h : max_keys;
+
+            for (int t = 1; t <= t_limit; t++) {
+                // Первый ключ вершины r, справа от него должно остаться t-1 ключей
+                const long long* col_j = P[t - 1] + col_index(0, j);
+                int last = j - (t - 1);
+                long long min_val = MULTI_INF;
+                int arg = i + 1;
+                for (int r = i + 1; r <= last; r++) {
+                    long long x = row_i[r - 1] + col_j[r];
+                    if (x < min_val) {
+                        min_val = x;
+                        arg = r;
+                    }
+                }
+                P[t][col_index(i, j)] = min_val;
+                plan->first[t][col_index(i, j)] = arg;
+                if (min_val < best) {
+                    best = min_val;
+                    best_t = t;
+                }
+            }
+
+            long long value = best + (prefix[j] - prefix[i]);
+            C[tri_index(n, i, j)] = value;
+            P[0][col_index(i, j)] = value;
+            plan->best_t[tri_index(n, i, j)] = (unsigned char)best_t;
+        }
+    }
+
+    for (int t = 0; t <= max_keys; t++) free(P[t]);
+    return 1;
+}
+
+void multiway_plan_free(MultiwayPlan* plan) {
+    free(plan->C);
+    free(plan->best_t);
+    for (int t = 1; t <= plan->max_keys; t++) free(plan->first[t]);
+}
+
+// Раскладка в ширину: все дети вершины лежат подряд, поэтому достаточно индекса
+// первого ребенка и маски непустых детей
+MultiNode* multiway_build(MultiwayPlan* plan, int* keys, int* node_count) {
+    int n = plan->n;
+    MultiNode* nodes = (MultiNode*)aligned_alloc(64, ((size_t)n * sizeof(MultiNode) + 63) / 64 * 64);
+    typedef struct {
+        int left;
+        int right;
+    } Range;
+    Range* queue = (Range*)malloc((size_t)n * sizeof(Range));
+    int head = 0, tail = 0;
+    queue[tail++] = (Range){0, n};
+
+    while (head < tail) {
+        int index = head;
+        Range r = queue[head++];
+        MultiNode* node = &nodes[index];
+        memset(node, 0, sizeof(*node));
+        for (int s = 0; s < MULTI_MAX_KEYS; s++) node->keys[s] = INT32_MAX;
+
+        int t = plan->best_t[tri_index(n, r.left, r.right)];
+        int bounds[MULTI_MAX_KEYS + 2];
+        bounds[0] = r.left;
+        int left = r.left;
+        for (int s = 0; s < t; s++) {
+            int key_index = plan->first[t - s][col_index(left, r.right)];
+            node->keys[s] = keys[key_index - 1];
+            bounds[s + 1] = key_index;
+            left = key_index;
+        }
+        node->count = (uint16_t)t;
+        node->first_child = tail;
+
+        // Ребенок s - интервал (bounds[s], bounds[s+1] - 1), последний - до r.right
+        for (int s = 0; s <= t; s++) {
+            int child_left = bounds[s];
+            int child_right = (s < t) ? bounds[s + 1] - 1 : r.right;
+            if (child_left < child_right) {
+                node->child_mask |= (uint16_t)(1u << s);
+                queue[tail++] = (Range){child_left, child_right};
+            }
+        }
+    }
+
+    free(queue);
+    *node_count = tail;
+    return nodes;
+}
+
+// ---------------- Поиск ----------------
+
+static inline int search_flat(const FlatNode* flat, int key) {
+    int i = 0;
+    while (i >= 0) {
+        if (key < flat[i].key) i = flat[i].left;
+        else if (key > flat[i].key) i = flat[i].right;
+        else return 1;
+    }
+    return 0;
+}
+
+// Все ключи вершины сравниваются сразу: четыре сравнения SSE2 по 4 ключа,
+// маски упаковываются в 16 бит; лишние дорожки (хвост строки) отсекает count
+static inline int search_multi(const MultiNode* nodes, int key) {
+    const MultiNode* p = nodes;
+#if defined(__SSE2__)
+    __m128i x = _mm_set1_epi32(key);
+#endif
+    for (;;) {
+#if defined(__SSE2__)
+        unsigned valid = (1u << p->count) - 1;
+        const __m128i* v = (const __m128i*)p->keys;
+        __m128i k0 = _mm_load_si128(v), k1 = _mm_load_si128(v + 1);
+        __m128i k2 = _mm_load_si128(v + 2), k3 = _mm_load_si128(v + 3);
+        __m128i eq = _mm_packs_epi16(_mm_packs_epi32(_mm_cmpeq_epi32(k0, x), _mm_cmpeq_epi32(k1, x)),
+                                     _mm_packs_epi32(_mm_cmpeq_epi32(k2, x), _mm_cmpeq_epi32(k3, x)));
+        if ((unsigned)_mm_movemask_epi8(eq) & valid) return 1;
+        __m128i lt = _mm_packs_epi16(_mm_packs_epi32(_mm_cmplt_epi32(k0, x), _mm_cmplt_epi32(k1, x)),
+                                     _mm_packs_epi32(_mm_cmplt_epi32(k2, x), _mm_cmplt_epi32(k3, x)));
+        int pos = __builtin_popcount((unsigned)_mm_movemask_epi8(lt) & valid);
+#else
+        int pos = 0;
+        while (pos < p->count && p->keys[pos] < key) pos++;
+        if (pos < p->count && p->keys[pos] == key) return 1;
+#endif
+        if (!((p->child_mask >> pos) & 1)) return 0;
+        p = nodes + p->first_child + __builtin_popcount(p->child_mask & ((1u << pos) - 1));
+    }
+}
+
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+double now_seconds() {
+    return now_ns() / 1e9;
+}
+
+void print_separator() {
+    printf("+--------------------+-----------+------------+-----------------+------------+\n");
+}
+
+void print_row(const char* name, int nodes, size_t bytes, double visits, double ns) {
+    printf("| %-18s | %9d | %10zu | %15.4f | %10.2f |\n", name, nodes, bytes, visits, ns);
+}
+
+int main(int argc, char* argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 1000;
+    int m = (argc > 2) ? atoi(argv[2]) : 5000000;
+    if (n < 1 || m < 1) {
+        printf("Использование: %s [n] [длина трассы]\n", argv[0]);
+        return 1;
+    }
+
+    int* keys = (int*)malloc(n * sizeof(int));
+    int* weights = (int*)malloc(n * sizeof(int));
+    long long* prefix = (long long*)malloc(((size_t)n + 1) * sizeof(long long));
+    srand(42);
+    prefix[0] = 0;
+    for (int i = 0; i < n; i++) {
+        keys[i] = 2 * i + 1;
+        weights[i] = rand() % 100 + 1;
+        prefix[i + 1] = prefix[i] + weights[i];
+    }
+    long long total_weight = prefix[n];
+
+    printf("ОПТИМАЛЬНОЕ СИЛЬНОВЕТВЯЩЕЕСЯ ДЕРЕВО (до %d ключей в вершине)\n", MULTI_MAX_KEYS);
+    printf("Количество ключей: %d, длина трассы: %d\n", n, m);
+#if defined(__SSE2__)
+    printf("Сравнение ключей вершины: SSE2\n\n");
+#else
+    printf("Сравнение ключей вершины: скалярное (SSE2 недоступно)\n\n");
+#endif
+
+    double start = now_seconds();
+    int* AR;
+    long long binary_cost = optimal_binary(weights, prefix, n, &AR);
+    double binary_time = now_seconds() - start;
+    FlatNode* flat = (FlatNode*)aligned_alloc(64, ((size_t)n * sizeof(FlatNode) + 63) / 64 * 64);
+    int next = 0;
+    freeze_binary(AR, keys, n, 0, n, flat, &next);
+    free(AR);
+
+    // При B = 1 динамика должна совпасть с алгоритмом Кнута
+    MultiwayPlan check;
+    if (!multiway_plan(&check, prefix, n, 1)) return 1;
+    long long check_cost = check.C[tri_index(n, 0, n)];
+    multiway_plan_free(&check);
+    printf("Проверка: B=1 дает %lld, алгоритм Кнута %lld - %s\n",
+           check_cost, binary_cost, check_cost == binary_cost ? "совпадает" : "ОШИБКА");
+
+    start = now_seconds();
+    MultiwayPlan plan;
+    if (!multiway_plan(&plan, prefix, n, MULTI_MAX_KEYS)) return 1;
+    long long multi_cost = plan.C[tri_index(n, 0, n)];
+    int node_count;
+    MultiNode* nodes = multiway_build(&plan, keys, &node_count);
+    multiway_plan_free(&plan);
+    double multi_time = now_seconds() - start;
+    printf("Построение: двоичное ДОП %.3f с, B=%d %.3f с\n\n", binary_time, MULTI_MAX_KEYS, multi_time);
+
+    // Трасса: ключ выбирается с вероятностью weight / total_weight
+    int* trace = (int*)malloc((size_t)m * sizeof(int));
+    unsigned long long state = 88172645463325252ULL;
+    for (int i = 0; i < m; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        long long u = (long long)(state % (unsigned long long)total_weight);
+        int lo = 0, hi = n - 1;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (prefix[mid + 1] <= u) lo = mid + 1;
+            else hi = mid;
+        }
+        trace[i] = keys[lo];
+    }
+
+    long long found_binary = 0, found_multi = 0;
+    start = now_ns();
+    for (int i = 0; i < m; i++) found_binary += search_flat(flat, trace[i]);
+    double binary_ns = (now_ns() - start) / m;
+    start = now_ns();
+    for (int i = 0; i < m; i++) found_multi += search_multi(nodes, trace[i]);
+    double multi_ns = (now_ns() - start) / m;
+    if (found_binary != m || found_multi != m) {
+        printf("Ошибка: найдено %lld и %lld из %d ключей\n", found_binary, found_multi, m);
+    }
+    // Отсутствующие ключи (четные) не должны находиться
+    for (int i = 0; i <= 2 * n; i += 2) {
+        if (search_multi(nodes, i) || search_flat(flat, i)) {
+            printf("Ошибка: найден отсутствующий ключ %d\n", i);
+            break;
+        }
+    }
+
+    print_separator();
+    printf("| %-18s | %-9s | %-10s | %-15s | %-10s |\n",
+           "Дерево", "Вершин", "Байт", "Посещ./поиск", "нс/поиск");
+    print_separator();
+    print_row("ДОП двоичное", n, (size_t)n * sizeof(FlatNode), (double)binary_cost / total_weight, binary_ns);
+    print_row("ДОП B=14 (SSE2)", node_count, (size_t)node_count * sizeof(MultiNode),
+              (double)multi_cost / total_weight, multi_ns);
+    print_separator();
+    printf("Посещение вершины B=14 - одна строка кэша; вершины двоичного дерева по 16 байт\n");
+
+    free(flat);
+    free(nodes);
+    free(trace);
+    free(keys);
+    free(weights);
+    free(prefix);
+    return 0;
+}
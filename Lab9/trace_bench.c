@@ -0,0 +1,282 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#endif
+
+#include "tree_common.h"
+
+// Замер поиска по трассе обращений для деревьев A1, A2 и ДОП.
+// Трасса выбирается по весам ключей, каждое дерево проверяется дважды:
+// как дерево на указателях и как "замороженный" массив вершин в прямом порядке обхода.
+// Деревья строятся теми же функциями из tree_common.h, что и в 1.c.
+// Сборка: gcc -O2 trace_bench.c -o trace_bench
+// Запуск: ./trace_bench [n] [длина трассы]
+
+// Вершина замороженного дерева: индексы детей в том же массиве, -1 - нет ребенка.
+// 16 байт, чтобы вершина никогда не пересекала границу строки кэша
+typedef struct FlatNode {
+    int key;
+    int left;
+    int right;
+    int pad;
+} FlatNode;
+
+typedef struct TraceResult {
+    double ns_per_lookup;
+    double cmp_per_lookup;
+    double misses_per_lookup;
+} TraceResult;
+
+double weighted_height(Node* root, int depth) {
+    if (root == NULL) return 0;
+    return (double)root->weight * depth +
+           weighted_height(root->left, depth + 1) +
+           weighted_height(root->right, depth + 1);
+}
+
+// ---------------- Замороженный массив ----------------
+
+// Прямой порядок обхода: левый ребенок всегда лежит сразу за родителем
+int flatten_tree(Node* root, FlatNode* flat, int* next) {
+    if (root == NULL) return -1;
+    int index = (*next)++;
+    flat[index].key = root->key;
+    flat[index].left = flatten_tree(root->left, flat, next);
+    flat[index].right = flatten_tree(root->right, flat, next);
+    return index;
+}
+
+// ---------------- Поиск ----------------
+
+long long comparisons = 0;
+
+static inline int search_tree(Node* p, int key) {
+    while (p != NULL) {
+        if (key < p->key) p = p->left;
+        else if (key > p->key) p = p->right;
+        else return 1;
+    }
+    return 0;
+}
+
+static inline int search_flat(FlatNode* flat, int key) {
+    int i = 0;
+    while (i >= 0) {
+        if (key < flat[i].key) i = flat[i].left;
+        else if (key > flat[i].key) i = flat[i].right;
+        else return 1;
+    }
+    return 0;
+}
+
+void count_tree_comparisons(Node* p, int key) {
+    while (p != NULL) {
+        comparisons++;
+        if (key < p->key) p = p->left;
+        else if (key > p->key) p = p->right;
+        else return;
+    }
+}
+
+// ---------------- Счетчик промахов кэша ----------------
+
+// Аппаратный счетчик через perf_event_open; если он недоступен
+// (нет прав или не Linux), промахи не выводятся
+int open_cache_counter() {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+void counter_start(int fd) {
+#ifdef __linux__
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+long long counter_stop(int fd) {
+    long long value = -1;
+#ifdef __linux__
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &value, sizeof(value)) != sizeof(value)) value = -1;
+    }
+#endif
+    return value;
+}
+
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// ---------------- Прогон трассы ----------------
+
+TraceResult run_tree(Node* root, int* trace, int m, int counter_fd) {
+    TraceResult r;
+    long long found = 0;
+
+    counter_start(counter_fd);
+    double start = now_ns();
+    for (int i = 0; i < m; i++) found += search_tree(root, trace[i]);
+    r.ns_per_lookup = (now_ns() - start) / m;
+    long long misses = counter_stop(counter_fd);
+    r.misses_per_lookup = (misses >= 0) ? (double)misses / m : -1;
+
+    comparisons = 0;
+    for (int i = 0; i < m; i++) count_tree_comparisons(root, trace[i]);
+    r.cmp_per_lookup = (double)comparisons / m;
+
+    if (found != m) printf("Ошибка: найдено %lld из %d ключей\n", found, m);
+    return r;
+}
+
+TraceResult run_flat(FlatNode* flat, int* trace, int m, int counter_fd, double cmp_per_lookup) {
+    TraceResult r;
+    long long found = 0;
+
+    counter_start(counter_fd);
+    double start = now_ns();
+    for (int i = 0; i < m; i++) found += search_flat(flat, trace[i]);
+    r.ns_per_lookup = (now_ns() - start) / m;
+    long long misses = counter_stop(counter_fd);
+    r.misses_per_lookup = (misses >= 0) ? (double)misses / m : -1;
+
+    // Форма дерева та же, что у дерева на указателях
+    r.cmp_per_lookup = cmp_per_lookup;
+
+    if (found != m) printf("Ошибка: найдено %lld из %d ключей\n", found, m);
+    return r;
+}
+
+void print_separator() {
+    printf("+--------------------+-----------------+-----------------+-----------------+\n");
+}
+
+void print_row(const char* name, TraceResult r) {
+    if (r.misses_per_lookup >= 0) {
+        printf("| %-18s | %15.2f | %15.3f | %15.3f |\n",
+               name, r.ns_per_lookup, r.cmp_per_lookup, r.misses_per_lookup);
+    } else {
+        printf("| %-18s | %15.2f | %15.3f | %15s |\n",
+               name, r.ns_per_lookup, r.cmp_per_lookup, "н/д");
+    }
+}
+
+void bench_tree(const char* name, const char* flat_name, Node* root, int n,
+                int* trace, int m, int counter_fd, long long total_weight) {
+    FlatNode* flat = (FlatNode*)aligned_alloc(64, ((size_t)n * sizeof(FlatNode) + 63) / 64 * 64);
+    int next = 0;
+    flatten_tree(root, flat, &next);
+
+    TraceResult tree = run_tree(root, trace, m, counter_fd);
+    TraceResult frozen = run_flat(flat, trace, m, counter_fd, tree.cmp_per_lookup);
+
+    print_row(name, tree);
+    print_row(flat_name, frozen);
+    printf("|   ср.взв.высота по весам: %-46.4f |\n", weighted_height(root, 1) / total_weight);
+    print_separator();
+    free(flat);
+}
+
+int main(int argc, char* argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 5000;
+    int m = (argc > 2) ? atoi(argv[2]) : 5000000;
+    if (n < 1 || m < 1) {
+        printf("Использование: %s [n] [длина трассы]\n", argv[0]);
+        return 1;
+    }
+
+    int* keys = (int*)malloc(n * sizeof(int));
+    int* weights = (int*)malloc(n * sizeof(int));
+    long long* cumulative = (long long*)malloc(n * sizeof(long long));
+    long long total_weight = 0;
+    srand(42);
+    for (int i = 0; i < n; i++) {
+        keys[i] = i + 1;
+        weights[i] = rand() % 100 + 1;
+        total_weight += weights[i];
+        cumulative[i] = total_weight;
+    }
+
+    // Трасса: ключ выбирается с вероятностью weight / total_weight
+    int* trace = (int*)malloc((size_t)m * sizeof(int));
+    unsigned long long state = 88172645463325252ULL;
+    for (int i = 0; i < m; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        long long u = (long long)(state % (unsigned long long)total_weight);
+        int lo = 0, hi = n - 1;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (cumulative[mid] <= u) lo = mid + 1;
+            else hi = mid;
+        }
+        trace[i] = keys[lo];
+    }
+
+    int counter_fd = open_cache_counter();
+
+    printf("ПОИСК ПО ТРАССЕ ОБРАЩЕНИЙ\n");
+    printf("Количество вершин: %d, длина трассы: %d\n", n, m);
+    if (counter_fd < 0) printf("Счетчик промахов кэша недоступен (perf_event_open)\n");
+    printf("\n");
+
+    print_separator();
+    printf("| %-18s | %15s | %15s | %15s |\n", "Дерево", "нс/поиск", "сравн./поиск", "промахи/поиск");
+    print_separator();
+
+    Node* a1_root = algorithm_a1(keys, weights, n);
+    bench_tree("A1", "A1 (массив)", a1_root, n, trace, m, counter_fd, total_weight);
+    free_tree(a1_root);
+
+    Node* a2_root = algorithm_a2(keys, weights, n);
+    bench_tree("A2", "A2 (массив)", a2_root, n, trace, m, counter_fd, total_weight);
+    free_tree(a2_root);
+
+    // ДОП строится точным алгоритмом из tree_common.h в пуле вершин
+    NodePool pool;
+    ExactScratch scratch;
+    pool.nodes = (Node*)malloc((size_t)n * sizeof(Node));
+    pool.used = 0;
+    if (pool.nodes && exact_scratch_init(&scratch, n)) {
+        Node* optimal_root = NULL;
+        exact_optimal(&scratch, keys, weights, n, &pool, &optimal_root);
+        exact_scratch_free(&scratch);
+        bench_tree("ДОП", "ДОП (массив)", optimal_root, n, trace, m, counter_fd, total_weight);
+    } else {
+        if (pool.nodes) exact_scratch_free(&scratch);
+        printf("| ДОП: недостаточно памяти для матриц при n=%-31d |\n", n);
+        print_separator();
+    }
+
+    free(pool.nodes);
+
+    if (counter_fd >= 0) close(counter_fd);
+    free(keys);
+    free(weights);
+    free(cumulative);
+    free(trace);
+    return 0;
+}
@@ -0,0 +1,499 @@
+#ifndef TREE_COMMON_H
+#define TREE_COMMON_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// Общая часть 1.c, trace_bench.c, image.c, hybrid.c и ingest.c: вершина дерева,
+// алгоритмы A1 и A2, точное ДОП, гибридное построение A2+ДОП и формат образа
+// дерева на диске. Каждая программа собирается из одного .c файла, поэтому
+// функции определены прямо здесь.
+
+#define DEFAULT_EXACT_THRESHOLD 128
+
+typedef struct Node {
+    int key;
+    int weight;
+    struct Node* left;
+    struct Node* right;
+    int bal;  // показатель баланса, нужен только АВЛ и ДБД в image.c
+} Node;
+
+Node* create_node(int key, int weight) {
+    Node* p = (Node*)malloc(sizeof(Node));
+    p->key = key;
+    p->weight = weight;
+    p->left = NULL;
+    p->right = NULL;
+    p->bal = 0;
+    return p;
+}
+
+void free_tree(Node* root) {
+    if (root == NULL) return;
+    free_tree(root->left);
+    free_tree(root->right);
+    free(root);
+}
+
+// ---------------- A1 и A2 ----------------
+
+// Запись для сортировки: ключ, вес и номер вставки в A1
+typedef struct KeyRecord {
+    int key;
+    int weight;
+    int rank;
+} KeyRecord;
+
+// Поразрядная сортировка записей (LSD, 4 прохода по байту). Сортировка устойчивая,
+// поэтому записи с равным ключом сортировки остаются в прежнем порядке.
+// Ключ сортировки - беззнаковое число, sort_key[i] относится к records[i]
+void radix_sort_records(KeyRecord* records, unsigned* sort_key, int n) {
+    KeyRecord* tmp_records = (KeyRecord*)malloc((size_t)n * sizeof(KeyRecord));
+    unsigned* tmp_key = (unsigned*)malloc((size_t)n * sizeof(unsigned));
+
+    for (int shift = 0; shift < 32; shift += 8) {
+        size_t count[257] = {0};
+        for (int i = 0; i < n; i++) {
+            count[((sort_key[i] >> shift) & 0xFF) + 1]++;
+        }
+        // Все записи в одной корзине - проход ничего не меняет
+        if (count[((sort_key[0] >> shift) & 0xFF) + 1] == (size_t)n) continue;
+        for (int b = 0; b < 256; b++) {
+            count[b + 1] += count[b];
+        }
+        for (int i = 0; i < n; i++) {
+            size_t pos = count[(sort_key[i] >> shift) & 0xFF]++;
+            tmp_records[pos] = records[i];
+            tmp_key[pos] = sort_key[i];
+        }
+        memcpy(records, tmp_records, (size_t)n * sizeof(KeyRecord));
+        memcpy(sort_key, tmp_key, (size_t)n * sizeof(unsigned));
+    }
+
+    free(tmp_records);
+    free(tmp_key);
+}
+
+// Ключ int в беззнаковый с сохранением порядка
+static inline unsigned order_key(int value) {
+    return (unsigned)value ^ 0x80000000u;
+}
+
+// Алгоритм A1 - вставка в BST в порядке убывания весов.
+// Такое дерево - декартово дерево: по ключам это BST, а каждая вершина вставлена
+// раньше своих потомков. Поэтому оно строится за O(n) стеком по ключам,
+// отсортированным вместе с номером вставки, без спуска от корня для каждой вершины
+Node* algorithm_a1(int* keys, int* weights, int n) {
+    if (n == 0) return NULL;
+
+    KeyRecord* records = (KeyRecord*)malloc(n * sizeof(KeyRecord));
+    unsigned* sort_key = (unsigned*)malloc(n * sizeof(unsigned));
+    for (int i = 0; i < n; i++) {
+        records[i].key = keys[i];
+        records[i].weight = weights[i];
+        sort_key[i] = ~order_key(weights[i]);
+    }
+
+    // Порядок вставки: по убыванию весов, равные веса - в исходном порядке
+    radix_sort_records(records, sort_key, n);
+    for (int i = 0; i < n; i++) {
+        records[i].rank = i;
+        sort_key[i] = order_key(records[i].key);
+    }
+
+    // По ключам; равный ключ при вставке уходит вправо, т.е. в обходе стоит
+    // после ранее вставленного - это дает устойчивость сортировки
+    radix_sort_records(records, sort_key, n);
+
+    // Правая граница дерева: ранги на стеке возрастают от дна к вершине
+    Node** stack = (Node**)malloc(n * sizeof(Node*));
+    int* stack_rank = (int*)malloc(n * sizeof(int));
+    int top = 0;
+    for (int i = 0; i < n; i++) {
+        Node* newNode = create_node(records[i].key, records[i].weight);
+        Node* last = NULL;
+        while (top > 0 && stack_rank[top - 1] > records[i].rank) {
+            last = stack[--top];
+        }
+        newNode->left = last;
+        if (top > 0) stack[top - 1]->right = newNode;
+        stack[top] = newNode;
+        stack_rank[top++] = records[i].rank;
+    }
+    Node* root = stack[0];
+
+    free(stack);
+    free(stack_rank);
+    free(records);
+    free(sort_key);
+    return root;
+}
+
+// Алгоритм A2 - построение с балансировкой по весам. prefix[i] - сумма первых i весов,
+// поэтому вес интервала берется за O(1), а корень ищется бинарным поиском.
+// gap_prefix[i] - сумма первых i весов лакун (NULL - промахов нет); лакуны слева от
+// ключа и сам ключ относятся к левой части.
+// Интервалы обрабатываются явным стеком: при равных весах дерево может быть глубоким
+Node* algorithm_a2_build(int* keys, int* weights, long long* prefix, long long* gap_prefix, int n) {
+    typedef struct {
+        int left;
+        int right;
+        Node** slot;
+    } Range;
+
+    Range* stack = (Range*)malloc(((size_t)n + 1) * sizeof(Range));
+    int top = 0;
+    Node* root = NULL;
+    stack[top++] = (Range){0, n - 1, &root};
+
+    while (top > 0) {
+        Range r = stack[--top];
+        if (r.left > r.right) continue;
+
+        if (r.left == r.right) {
+            *r.slot = create_node(keys[r.left], weights[r.left]);
+            continue;
+        }
+
+        // Вес ключей r.left..k вместе с лакунами r.left..k
+        long long left_weight(int k) {
+            long long w = prefix[k + 1] - prefix[r.left];
+            if (gap_prefix != NULL) w += gap_prefix[k + 1] - gap_prefix[r.left];
+            return w;
+        }
+
+        // Находим корень - первый узел, где сумма весов превышает половину
+        long long total = prefix[r.right + 1] - prefix[r.left];
+        if (gap_prefix != NULL) total += gap_prefix[r.right + 2] - gap_prefix[r.left];
+        long long half = total / 2;
+        int lo = r.left, hi = r.right;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (left_weight(mid) > half) hi = mid;
+            else lo = mid + 1;
+        }
+        // Если половина достигнута ровно на границе, корнем остается левый узел
+        int root_index = (left_weight(lo - 1) < half) ? lo : r.left;
+
+        Node* node = create_node(keys[root_index], weights[root_index]);
+        *r.slot = node;
+        stack[top++] = (Range){r.left, root_index - 1, &node->left};
+        stack[top++] = (Range){root_index + 1, r.right, &node->right};
+    }
+
+    free(stack);
+    return root;
+}
+
+Node* algorithm_a2(int* keys, int* weights, int n) {
+    if (n == 0) return NULL;
+
+    // Сортировка по ключам, равные ключи - в исходном порядке
+    KeyRecord* records = (KeyRecord*)malloc(n * sizeof(KeyRecord));
+    unsigned* sort_key = (unsigned*)malloc(n * sizeof(unsigned));
+    for (int i = 0; i < n; i++) {
+        records[i].key = keys[i];
+        records[i].weight = weights[i];
+        sort_key[i] = order_key(keys[i]);
+    }
+    radix_sort_records(records, sort_key, n);
+
+    // Создаем отсортированные массивы и префиксные суммы весов
+    int* sorted_keys = (int*)malloc(n * sizeof(int));
+    int* sorted_weights = (int*)malloc(n * sizeof(int));
+    long long* prefix = (long long*)malloc(((size_t)n + 1) * sizeof(long long));
+    prefix[0] = 0;
+    for (int i = 0; i < n; i++) {
+        sorted_keys[i] = records[i].key;
+        sorted_weights[i] = records[i].weight;
+        prefix[i + 1] = prefix[i] + records[i].weight;
+    }
+
+    Node* root = algorithm_a2_build(sorted_keys, sorted_weights, prefix, NULL, n);
+
+    free(records);
+    free(sort_key);
+    free(sorted_keys);
+    free(sorted_weights);
+    free(prefix);
+    return root;
+}
+
+// ---------------- Гибридное построение ----------------
+
+// Все вершины берутся из одного массива: миллион malloc заметен на фоне построения
+typedef struct NodePool {
+    Node* nodes;
+    int used;
+} NodePool;
+
+// Рабочие массивы точного ДОП, выделяются один раз под максимальный интервал
+typedef struct ExactScratch {
+    int capacity;
+    long long* AP;
+    int* AR;
+    long long* prefix;
+} ExactScratch;
+
+Node* pool_node(NodePool* pool, int key, int weight) {
+    Node* node = &pool->nodes[pool->used++];
+    node->key = key;
+    node->weight = weight;
+    node->left = NULL;
+    node->right = NULL;
+    node->bal = 0;
+    return node;
+}
+
+// Индекс клетки (i, j), i <= j, в упакованной по строкам треугольной матрице
+static inline size_t tri_index(int n, int i, int j) {
+    return (size_t)i * (2 * (size_t)n + 3 - i) / 2 + (j - i);
+}
+
+int exact_scratch_init(ExactScratch* s, int capacity) {
+    size_t cells = ((size_t)capacity + 1) * ((size_t)capacity + 2) / 2;
+    s->capacity = capacity;
+    s->AP = (long long*)malloc(cells * sizeof(long long));
+    s->AR = (int*)malloc(cells * sizeof(int));
+    s->prefix = (long long*)malloc(((size_t)capacity + 1) * sizeof(long long));
+    return s->AP && s->AR && s->prefix;
+}
+
+void exact_scratch_free(ExactScratch* s) {
+    free(s->AP);
+    free(s->AR);
+    free(s->prefix);
+}
+
+// Точное ДОП (алгоритм Кнута) на ключах keys[0..n-1]; возвращает AP[0][n]
+long long exact_optimal(ExactScratch* s, int* keys, int* weights, int n, NodePool* pool, Node** out) {
+    long long* AP = s->AP;
+    int* AR = s->AR;
+    long long* prefix = s->prefix;
+
+    prefix[0] = 0;
+    for (int i = 0; i < n; i++) prefix[i + 1] = prefix[i] + weights[i];
+
+    for (int i = 0; i <= n; i++) {
+        AP[tri_index(n, i, i)] = 0;
+        AR[tri_index(n, i, i)] = 0;
+    }
+    for (int i = 0; i < n; i++) {
+        AP[tri_index(n, i, i + 1)] = weights[i];
+        AR[tri_index(n, i, i + 1)] = i + 1;
+    }
+    for (int h = 2; h <= n; h++) {
+        for (int i = 0; i <= n - h; i++) {
+            int j = i + h;
+            long long* row_i = AP + tri_index(n, i, i) - i;
+            int m = AR[tri_index(n, i, j - 1)];
+            long long min_val = row_i[m - 1] + AP[tri_index(n, m, j)];
+            int max_k = AR[tri_index(n, i + 1, j)];
+            for (int k = m + 1; k <= max_k; k++) {
+                long long x = row_i[k - 1] + AP[tri_index(n, k, j)];
+                if (x < min_val) {
+                    m = k;
+                    min_val = x;
+                }
+            }
+            AP[tri_index(n, i, j)] = min_val + (prefix[j] - prefix[i]);
+            AR[tri_index(n, i, j)] = m;
+        }
+    }
+
+    void build_tree(int L, int R, Node** slot) {
+        if (L >= R) {
+            *slot = NULL;
+            return;
+        }
+        int k = AR[tri_index(n, L, R)];
+        *slot = pool_node(pool, keys[k - 1], weights[k - 1]);
+        build_tree(L, k - 1, &(*slot)->left);
+        build_tree(k, R, &(*slot)->right);
+    }
+
+    build_tree(0, n, out);
+    return AP[tri_index(n, 0, n)];
+}
+
+// Гибридное построение: prefix - префиксные суммы весов всего массива
+Node* hybrid_build(int* keys, int* weights, int n, int threshold, NodePool* pool) {
+    long long* prefix = (long long*)malloc(((size_t)n + 1) * sizeof(long long));
+    prefix[0] = 0;
+    for (int i = 0; i < n; i++) prefix[i + 1] = prefix[i] + weights[i];
+
+    ExactScratch scratch;
+    if (!exact_scratch_init(&scratch, threshold)) {
+        printf("Ошибка: не удалось выделить память для порога %d\n", threshold);
+        exact_scratch_free(&scratch);
+        free(prefix);
+        return NULL;
+    }
+
+    // Явный стек интервалов: при сильно неравных весах глубина верхней части
+    // может быть большой
+    typedef struct {
+        int left;
+        int right;
+        Node** slot;
+    } Range;
+    Range* stack = (Range*)malloc(((size_t)n + 1) * sizeof(Range));
+    int top = 0;
+    Node* root = NULL;
+    stack[top++] = (Range){0, n - 1, &root};
+
+    while (top > 0) {
+        Range r = stack[--top];
+        int size = r.right - r.left + 1;
+        if (size <= 0) {
+            *r.slot = NULL;
+            continue;
+        }
+        if (size <= threshold) {
+            exact_optimal(&scratch, keys + r.left, weights + r.left, size, pool, r.slot);
+            continue;
+        }
+
+        // Корень - первый ключ, на котором вес от левого края превышает половину интервала
+        long long half = (prefix[r.right + 1] - prefix[r.left]) / 2;
+        int lo = r.left, hi = r.right;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (prefix[mid + 1] - prefix[r.left] > half) hi = mid;
+            else lo = mid + 1;
+        }
+        // Если половина достигнута ровно на границе, корнем остается левый ключ - как в A2
+        int root_index = (prefix[lo] - prefix[r.left] < half) ? lo : r.left;
+
+        Node* node = pool_node(pool, keys[root_index], weights[root_index]);
+        *r.slot = node;
+        stack[top++] = (Range){r.left, root_index - 1, &node->left};
+        stack[top++] = (Range){root_index + 1, r.right, &node->right};
+    }
+
+    free(stack);
+    exact_scratch_free(&scratch);
+    free(prefix);
+    return root;
+}
+
+// ---------------- Формат образа ----------------
+
+// Образ: заголовок со статистикой и контрольной суммой и плоский массив вершин
+// в прямом порядке обхода; потомки заданы смещением относительно самой вершины
+#define IMAGE_MAGIC "SAODTREE"
+#define IMAGE_VERSION 1
+// Слово с известным значением: образ, записанный на машине с другим порядком байт,
+// не пройдет проверку заголовка
+#define IMAGE_BYTE_ORDER 0x01020304u
+
+// A2 и гибрид записывает ingest.c по частотам ключей из журналов
+enum TreeKind { KIND_DOP = 1, KIND_AVL, KIND_DBD, KIND_ISDP, KIND_A2, KIND_HYBRID };
+
+const char* kind_names[] = {"", "ДОП", "АВЛ", "ДБД", "ИСДП", "A2", "Гибрид A2+ДОП"};
+
+// Все поля фиксированного размера, заголовок кратен 8 байтам
+typedef struct ImageHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t kind;
+    uint32_t node_count;
+    uint32_t height;
+    uint32_t reserved;
+    int64_t control_sum;
+    int64_t total_weight;
+    int64_t weighted_height;
+    uint64_t checksum;
+} ImageHeader;
+
+// Смещения left/right считаются в вершинах от текущей, 0 - потомка нет.
+// Корень - нулевая вершина массива
+typedef struct ImageNode {
+    int32_t key;
+    int32_t weight;
+    int32_t left;
+    int32_t right;
+} ImageNode;
+
+// ---------------- Запись образа ----------------
+
+// FNV-1a по байтам массива вершин
+uint64_t image_checksum(const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Раскладывает дерево в прямом порядке и заполняет статистику заголовка.
+// Левый потомок всегда лежит сразу за вершиной, правый - после всего левого поддерева
+ImageNode* freeze_tree(Node* root, int n, ImageHeader* header) {
+    ImageNode* nodes = (ImageNode*)malloc((size_t)n * sizeof(ImageNode));
+    typedef struct {
+        Node* node;
+        int parent;
+        int is_left;
+        int depth;
+    } Pending;
+    Pending* stack = (Pending*)malloc(((size_t)n + 1) * sizeof(Pending));
+    int top = 0, count = 0;
+    if (root != NULL) stack[top++] = (Pending){root, -1, 0, 1};
+
+    while (top > 0) {
+        Pending item = stack[--top];
+        Node* p = item.node;
+        int index = count++;
+        nodes[index] = (ImageNode){p->key, p->weight, 0, 0};
+        if (item.parent >= 0) {
+            ImageNode* parent = &nodes[item.parent];
+            if (item.is_left) parent->left = index - item.parent;
+            else parent->right = index - item.parent;
+        }
+
+        header->control_sum += p->key;
+        header->total_weight += p->weight;
+        header->weighted_height += (int64_t)p->weight * item.depth;
+        if ((uint32_t)item.depth > header->height) header->height = item.depth;
+
+        // Правый кладется первым, чтобы левое поддерево целиком вышло раньше
+        if (p->right) stack[top++] = (Pending){p->right, index, 0, item.depth + 1};
+        if (p->left) stack[top++] = (Pending){p->left, index, 1, item.depth + 1};
+    }
+    free(stack);
+
+    header->node_count = count;
+    header->checksum = image_checksum(nodes, (size_t)count * sizeof(ImageNode));
+    return nodes;
+}
+
+// header заполняется статистикой записанного дерева
+int save_image(const char* path, Node* root, int n, int kind, ImageHeader* header) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, IMAGE_MAGIC, sizeof(header->magic));
+    header->version = IMAGE_VERSION;
+    header->byte_order = IMAGE_BYTE_ORDER;
+    header->kind = kind;
+
+    ImageNode* nodes = freeze_tree(root, n, header);
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        printf("Ошибка: не удалось открыть %s для записи\n", path);
+        free(nodes);
+        return 0;
+    }
+    int ok = fwrite(header, sizeof(*header), 1, file) == 1 &&
+              fwrite(nodes, sizeof(ImageNode), header->node_count, file) == header->node_count;
+    ok = (fclose(file) == 0) && ok;
+    free(nodes);
+    if (!ok) printf("Ошибка записи в %s\n", path);
+    return ok;
+}
+
+#endif